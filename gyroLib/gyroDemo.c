@@ -45,14 +45,25 @@ task main()
 {
     bLCDBacklight = true;
 
+#ifdef  GYRO_TELEMETRY
+    // Telemetry records go out of UART1
+    configureSerialPort( uartOne, uartUserControl );
+    setBaudRate( uartOne, baudRate115200 );
+#endif
+
     // Initialize the gyro on the default analog port (in1)
     GyroInit();
 
     while(1)
         {
-        // Show the gyro angle on the LCD
+        // Show the gyro angle on the LCD, redrawn only when it changes
         GyroDebug(1);
 
+#ifdef  GYRO_TELEMETRY
+        // Send the records GyroTask has written since last time
+        GyroTelemetrySend();
+#endif
+
         wait1Msec(20);
         }
 }
@@ -19,6 +19,26 @@
 /*                V0.3 3 May 2015                                              */
 /*                     Cleanup, doxygen comments, update license               */
 /*                                                                             */
+/*                V0.4 16 Oct 2026                                             */
+/*                     Multiple gyros polled by one task                       */
+/*                     Optional fixed point angle calculation                  */
+/*                     Consistent snapshot of gyro state                       */
+/*                     Configurable polling period                             */
+/*                     Hot reinit that holds the heading                       */
+/*                     Optional online drift estimator                         */
+/*                     Raw analog backend integrating at 1mS                   */
+/*                     Compile time gyro profiles                              */
+/*                     Optional loop timing                                    */
+/*                     History of recent passes, heading at a given time       */
+/*                     Binary telemetry, GyroDebug redraws only on change      */
+/*                     Gyro and encoder odometry                               */
+/*                     Profiled turn to angle and heading hold                 */
+/*                     Drift threshold and window set at run time              */
+/*                     Odometry only built with GYRO_ODOMETRY                  */
+/*                     Turn controller only built with GYRO_TURN               */
+/*                     Recalibrating flag, raw hot reinit keeps integrating    */
+/*                     Raw backend jitter set at run time                      */
+/*                                                                             */
 /*-----------------------------------------------------------------------------*/
 /*                                                                             */
 /*    The author is supplying this software for use with the VEX IQ            */
@@ -55,19 +75,303 @@
   * @brief   VEX gyro wrapper functions for ROBOTC
 *//*---------------------------------------------------------------------------*/
 
-// Structure to hold global info for the gyro
-typedef struct _gyroData {
-    tSensors    port;           ///< analog port the gyro is connected to
-    bool        valid;          ///< indicates gyro is initialized
-    float       angle;          ///< angle in range 0 to 360 deg
-    float       abs_angle;      ///< absolute angle, both positive and negative
-    int         drift_error;    ///< accumulated error due to drift
-    } gyroData;
+// Gyro scale, jitter band, mounting and drift threshold
+#include "gyroProfile.h"
+#include "gyroTiming.h"
+#ifdef  GYRO_TELEMETRY
+#include "gyroTelemetry.h"
+#endif
+#ifdef  GYRO_ODOMETRY
+#include "gyroOdometry.h"
+#endif
+#ifdef  GYRO_TURN
+#include "gyroTurn.h"
+#endif
+
+// Maximum number of gyros, one task polls all of them
+#define kMaxGyros               4
+
+/// handle for one gyro, GyroInit always creates gyro 0
+typedef int tGyro;
+
+// Define GYRO_FIXED_POINT before including this file to keep angles as
+// scaled integers, there is no FPU on the cortex so this removes all the
+// soft float calls from GyroTask.  Angles are only converted to float by
+// the get functions.  The absolute angle also keeps full resolution however
+// many turns are made.
+#ifdef  GYRO_FIXED_POINT
+// angle units per (deg * 10) from the sensor, leaves room for fractions
+#define GYRO_FIXED_SCALE        16
+
+typedef long  tGyroAngle;
+
+#define GYRO_ANGLE_SCALE        (10 * GYRO_FIXED_SCALE)
+#define GyroAngleFromValue(v)   ((long)(v) * GYRO_FIXED_SCALE)
+#define GyroAngleToDeg(a)       ((a) * (1.0 / GYRO_ANGLE_SCALE))
+#else
+typedef float tGyroAngle;
+
+#define GYRO_ANGLE_SCALE        1
+#define GyroAngleFromValue(v)   ((v) / 10.0)
+#define GyroAngleToDeg(a)       (a)
+#endif
+
+// angle units in whole and half turns
+#define GYRO_ANGLE_360          (360 * GYRO_ANGLE_SCALE)
+#define GYRO_ANGLE_180          (180 * GYRO_ANGLE_SCALE)
+
+#ifdef  GYRO_FIXED_POINT
+// deg * 160 to deg * 100 without a float
+#define GyroAngleToCenti(a)     ((a) * 5 / 8)
+#else
+#define GyroAngleToCenti(a)     ((long)(GyroAngleToDeg(a) * 100.0))
+#endif
+
+#define GyroAngleToRad(a)       ((a) * (PI / (180.0 * GYRO_ANGLE_SCALE)))
+
+// The drift estimator works in gyro units (deg * 10) with 16 fraction bits
+#define GYRO_FINE_SHIFT         16
+#ifdef  GYRO_FIXED_POINT
+#define GyroAngleFromFine(q)    ((q) >> (GYRO_FINE_SHIFT - 4))
+#else
+#define GyroAngleFromFine(q)    ((q) * (1.0 / (10.0 * 65536.0)))
+#endif
+
+// The raw backend integrates counts * mS, GYRO_RAW_SCALE of them per deg * 10
+#define GYRO_RAW_SCALE          GYRO_P_SCALE
+#define GYRO_RAW_360            (3600L * GYRO_RAW_SCALE)
+#ifdef  GYRO_FIXED_POINT
+#define GyroAngleFromRaw(r)     (((r) * GYRO_FIXED_SCALE) / GYRO_RAW_SCALE)
+#else
+#define GyroAngleFromRaw(r)     ((r) * (1.0 / (10.0 * GYRO_RAW_SCALE)))
+#endif
+
+// Passes kept for GyroAngleAbsAtN and friends, a power of 2.  At the
+// default period this is the last 1.28 seconds.
+#ifndef GYRO_HISTORY_SIZE
+#define GYRO_HISTORY_SIZE       64
+#endif
+
+// Structure to hold the results of one pass of the polling task
+typedef struct _gyroSample {
+    long        time;                           ///< nSysTime when sampled
+    long        dt;                             ///< mS since the previous pass
+    bool        valid[kMaxGyros];               ///< indicates gyro is initialized
+    bool        recal[kMaxGyros];               ///< hot reinit running, the robot must not move
+    tGyroAngle  angle[kMaxGyros];               ///< angle in range 0 to 360 deg
+    tGyroAngle  abs_angle[kMaxGyros];           ///< absolute angle, both positive and negative
+    tGyroAngle  delta[kMaxGyros];               ///< change since the previous pass
+#ifdef  GYRO_ODOMETRY
+    long        pose_x;                         ///< odometry, counts << GYRO_ODO_SHIFT
+    long        pose_y;                         ///< odometry, counts << GYRO_ODO_SHIFT
+#endif
+    } gyroSample;
+
+// Structure to hold global info for all the gyros
+// Each member is an array indexed by gyro handle so that the polling task
+// walks each array in turn rather than jumping between per gyro structures.
+// Results are double buffered, the task fills the sample that readers are
+// not using and then increments sequence to publish it.
+typedef struct _gyroTable {
+    int         count;                          ///< number of gyros in use
+    int         period;                         ///< polling period in mS
+    int         drift_mode;                     ///< kGyroDriftThreshold or kGyroDriftEstimator
+    int         drift_threshold;                ///< threshold, smaller changes are drift
+    int         drift_window;                   ///< threshold, mS between drift checks
+    bool        tuned;                          ///< run time settings have their defaults
+    int         backend;                        ///< kGyroBackendFirmware or kGyroBackendRaw
+    tSensors    port[kMaxGyros];                ///< analog port the gyro is connected to
+    int         drift_error[kMaxGyros];         ///< accumulated error due to drift
+    int         lastDriftGyro[kMaxGyros];       ///< gyro value at last drift check
+    int         last_value[kMaxGyros];          ///< gyro value from previous pass
+    long        still_sum[kMaxGyros];           ///< estimator, change since last motion
+    long        bias_q[kMaxGyros];              ///< estimator, drift rate per mS
+    long        drift_q[kMaxGyros];             ///< estimator, accumulated drift correction
+    long        still_time[kMaxGyros];          ///< estimator, mS since last motion
+    tGyroAngle  old_angle[kMaxGyros];           ///< angle from previous pass
+    tGyroAngle  abs_angle[kMaxGyros];           ///< running absolute angle
+    tGyroAngle  offset[kMaxGyros];              ///< heading carried over a hot reinit
+    bool        recal_request[kMaxGyros];       ///< hot reinit requested
+    long        recal_time[kMaxGyros];          ///< hot reinit, when to restart the gyro
+    long        recal_end[kMaxGyros];           ///< hot reinit, when the firmware is done
+    int         raw_jitter;                     ///< raw, changes this small from the bias are noise
+    int         raw_bias[kMaxGyros];            ///< raw, whole counts of bias
+    long        raw_small[kMaxGyros];           ///< raw, fraction of bias in counts * 1024
+    long        raw_acc[kMaxGyros];             ///< raw, integrated counts * mS in one turn
+    long        raw_cycles[kMaxGyros];          ///< raw, mS integrated since the last small bias step
+    long        raw_turns[kMaxGyros];           ///< raw, whole turns made
+    int         cal_n[kMaxGyros];               ///< raw calibration, samples taken
+    int         cal_first[kMaxGyros];           ///< raw calibration, first sample
+    float       cal_acc[kMaxGyros];             ///< raw calibration, sum of deviations
+    float       cal_sq[kMaxGyros];              ///< raw calibration, sum of squared deviations
+    long        sequence;                       ///< passes published, sample[sequence & 1] is current
+    gyroSample  sample[2];
+    long        hist_head;                      ///< passes pushed into the history
+    long        hist_time[GYRO_HISTORY_SIZE];   ///< nSysTime of each pass
+    tGyroAngle  hist_abs[GYRO_HISTORY_SIZE][kMaxGyros];   ///< absolute angle of each gyro
+#ifdef  GYRO_TIMING
+    gyroTiming  timing;                         ///< polling loop timing
+#endif
+#ifdef  GYRO_TELEMETRY
+    gyroTelemetry telemetry;                    ///< records waiting to be sent
+#endif
+#ifdef  GYRO_ODOMETRY
+    gyroOdometry  odometry;                     ///< pose from the gyro and encoders
+#endif
+#ifdef  GYRO_TURN
+    gyroTurn    turn;                           ///< turn controller
+#endif
+    long        debug_shown;                    ///< GyroDebug angle on the LCD, deg * 10
+    } gyroTable;
+
+/// A consistent copy of the state of one gyro
+typedef struct _gyroSnapshot {
+    bool        valid;                          ///< indicates gyro is initialized
+    bool        recalibrating;                  ///< hot reinit running, the robot must not move
+    float       angle;                          ///< angle in range 0 to 360 deg
+    float       abs_angle;                      ///< absolute angle, both positive and negative
+    float       rate;                           ///< angular rate in deg/sec
+    long        time;                           ///< nSysTime when sampled
+    long        sequence;                       ///< increments every sample
+    } gyroSnapshot;
 
 // local storage for the gyro calculations
-static  gyroData    theGyro;
+static  gyroTable   theGyros;
+
+// Drift correction
+//   kGyroDriftThreshold   any change under the threshold in a drift
+//                         window is treated as drift and removed
+//   kGyroDriftEstimator   the drift rate is estimated every pass while the
+//                         robot is still and removed all the time
+#define kGyroDriftThreshold     0
+#define kGyroDriftEstimator     1
+
+// Defaults, GyroDriftParamsSet can change both
+#define GYRO_DRIFT_THRESHOLD    GYRO_P_DRIFT_THRESHOLD
+
+// Drift is checked over a fixed time window whatever the polling period
+#define GYRO_DRIFT_WINDOW       250
+#define GYRO_DRIFT_WINDOW_MAX   5000
+
+// Estimator, the bias is gyro units per mS << GYRO_FINE_SHIFT
+#define GYRO_EST_WINDOW         1024    ///< mS of stillness averaged for each update
+#define GYRO_EST_STILL_STEP     2       ///< a change of this many units in one pass is motion
+#define GYRO_EST_STILL_COUNT    5       ///< more change than this in a window, 0.5 deg/sec, is motion
+#define GYRO_EST_BIAS_SHIFT     2       ///< each window moves the bias a quarter of the way
+#define GYRO_EST_DRIFT_WRAP     (3600L << GYRO_FINE_SHIFT)
+
+// Where the gyro value comes from
+//   kGyroBackendFirmware  ROBOTC integrates the gyro every 1mS and GyroTask
+//                         reads the result every period
+//   kGyroBackendRaw       GyroRawTask reads the analog port every 1mS and
+//                         does everything itself, as gyroSim.c does
+#define kGyroBackendFirmware    0
+#define kGyroBackendRaw         1
+
+// Raw backend, the same constants gyroSim.c uses
+#define GYRO_RAW_JITTER         GYRO_P_JITTER   ///< changes this small are noise, GyroRawJitterSet
+#define GYRO_RAW_JITTER_MAX     32
+#define GYRO_RAW_SETTLE         100     ///< mS before calibration starts
+#define GYRO_RAW_CAL_MIN        64      ///< calibration samples, at least
+#define GYRO_RAW_CAL_MAX        1024    ///< calibration samples, at most
+#define GYRO_RAW_CAL_TOLERANCE  8       ///< stop when bias is good to 1/this counts
+#define GYRO_RAW_REFINE         1024    ///< estimator, quiet samples per bias update
+#define GYRO_RAW_STILL          8       ///< estimator, larger changes are motion
+
+// Time the gyro is disabled for during a reinit, the firmware needs to see
+// the change of type
+#define GYRO_REINIT_TIME        500
+// The firmware has no calibration done flag, a ROBOTC calibration is 200mS
+// of settling and then 1024 samples at 1mS
+#define GYRO_FW_CAL_TIME        1300
+
+// Polling period in mS, the firmware updates the gyro every 1mS so shorter
+// periods reduce latency at the cost of more cpu time
+#define GYRO_PERIOD_DEFAULT     20
+#define GYRO_PERIOD_MIN         1
+#define GYRO_PERIOD_MAX         100
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Clear the drift correction for a gyro                           */
+/** @param[in] gyro the gyro handle                                            */
+/*-----------------------------------------------------------------------------*/
+
+void
+GyroDriftReset( tGyro gyro )
+{
+    theGyros.drift_error[gyro]   = 0;
+    theGyros.lastDriftGyro[gyro] = 0;
+    theGyros.last_value[gyro]    = 0;
+    theGyros.still_sum[gyro]     = 0;
+    theGyros.bias_q[gyro]        = 0;
+    theGyros.drift_q[gyro]       = 0;
+    theGyros.still_time[gyro]    = 0;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Add the pass just made to the history                           */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Only the absolute angle is kept, the angle is the same modulo 360 and
+ *   the rate is the difference between passes.  The entry is complete
+ *   before hist_head moves on so readers never see half of it.
+ */
+void
+GyroHistoryPush()
+{
+    int     k = theGyros.hist_head & (GYRO_HISTORY_SIZE - 1);
+    tGyro   i;
+
+    theGyros.hist_time[k] = nSysTime;
+    for(i=0;i<theGyros.count;i++)
+        theGyros.hist_abs[k][i] = theGyros.abs_angle[i];
+
+    theGyros.hist_head++;
+}
+
+#ifdef  GYRO_ODOMETRY
+/*-----------------------------------------------------------------------------*/
+/** @brief     Move the pose on by one pass                                    */
+/** @param[in] next the sample being filled                                    */
+/*-----------------------------------------------------------------------------*/
+void
+GyroOdometryUpdate( int next )
+{
+    tGyro   g = theGyros.odometry.gyro;
+
+    if( !theGyros.odometry.enabled )
+        return;
 
-#define GYRO_DRIFT_THRESHOLD    3
+    // the pose stops during a hot reinit and starts again from the encoders
+    GyroOdometryMove( &theGyros.odometry, theGyros.sample[next].valid[g] && !theGyros.sample[next].recal[g],
+                      GyroAngleToPhase( theGyros.sample[next].angle[g] ) );
+
+    theGyros.sample[next].pose_x = theGyros.odometry.x;
+    theGyros.sample[next].pose_y = theGyros.odometry.y;
+}
+#endif
+
+#ifdef  GYRO_TURN
+/*-----------------------------------------------------------------------------*/
+/** @brief     Run the turn controller for the pass just published             */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Runs straight after each gyro pass so it always works on a fresh
+ *   heading and rate.
+ */
+void
+GyroTurnUpdate()
+{
+    int     b = theGyros.sequence & 1;
+    float   rate;
+
+    rate = (theGyros.sample[b].dt > 0) ? GyroAngleToDeg( theGyros.sample[b].delta[0] ) * 1000.0 / theGyros.sample[b].dt : 0;
+
+    // a hot reinit holds or rebuilds the heading, not one to steer by
+    GyroTurnStep( &theGyros.turn, theGyros.sample[b].valid[0] && !theGyros.sample[b].recal[0],
+                  GyroAngleToDeg( theGyros.sample[b].abs_angle[0] ), rate );
+}
+#endif
 
 /*-----------------------------------------------------------------------------*/
 /** @brief display current gyro angle on the LCD for debug pruposes            */
@@ -77,11 +381,24 @@ void
 GyroDebug( int displayLine )
 {
     string str;
+    int    b = theGyros.sequence & 1;
+    long   shown;
 
-    if( theGyro.valid )
+    // what would be displayed, -1 for not ready
+    if( theGyros.sample[b].valid[0] )
+        shown = GyroAngleToDeg( theGyros.sample[b].angle[0] ) * 10.0 + 0.5;
+    else
+        shown = -1;
+
+    // the LCD is slow, only write it when the text changes
+    if( shown == theGyros.debug_shown )
+        return;
+    theGyros.debug_shown = shown;
+
+    if( shown >= 0 )
         {
         // display current value
-        sprintf(str,"Gyro %5.1f   ", theGyro.angle );
+        sprintf(str,"Gyro %5.1f   ", shown / 10.0 );
         displayLCDString(displayLine, 0, str);
         }
     else
@@ -95,116 +412,1242 @@ GyroDebug( int displayLine )
 task GyroTask()
 {
     int     gyro_value;
-    int     lastDriftGyro = 0;
 
-    float   angle;
-    float   old_angle = 0.0;
-    float   delta_angle = 0.0;
+    tGyroAngle  angle;
+    tGyroAngle  delta_angle = 0;
 
     long    nSysTimeOffset;
+    long    lastTime;
+    long    dt;
+    int     d;
+    long    e;
+    bool    driftCheck;
+    int     next;
+    tGyro   i;
+
+    // sample the readers are not using
+    next = (theGyros.sequence + 1) & 1;
+
+    for(i=0;i<theGyros.count;i++)
+        {
+        // Gyro readings invalid
+        theGyros.sample[next].valid[i]     = false;
+        theGyros.sample[next].angle[i]     = 0;
+        theGyros.sample[next].abs_angle[i] = 0;
+        theGyros.sample[next].delta[i]     = 0;
+
+        // clear absolute
+        theGyros.abs_angle[i] = 0;
 
-    // Gyro readings invalid
-    theGyro.valid = false;
+        // clear drift error and local parameters
+        GyroDriftReset( i );
+        theGyros.old_angle[i]     = 0;
+        theGyros.offset[i]        = 0;
 
-    // clear absolute
-    theGyro.abs_angle = 0;
+        // a full reinit supersedes any hot reinit
+        theGyros.recal_request[i] = false;
+        theGyros.recal_time[i]    = 0;
+        theGyros.recal_end[i]     = 0;
+        theGyros.sample[next].recal[i] = false;
+
+        // Cause the gyro to reinitialize
+        SensorType[theGyros.port[i]] = sensorNone;
+        }
 
-    // clear drift error
-    theGyro.drift_error = 0;
+    // publish
+    theGyros.sample[next].time = nSysTime;
+    theGyros.sample[next].dt   = 0;
+    theGyros.sequence++;
 
-    // Cause the gyro to reinitialize
-    SensorType[theGyro.port] = sensorNone;
+    // nothing from before the restart
+    theGyros.hist_head  = 0;
+#ifdef  GYRO_ODOMETRY
+    theGyros.odometry.primed = false;
+#endif
 
     // Wait 1/2 sec
-    wait1Msec(500);
+    wait1Msec(GYRO_REINIT_TIME);
 
-    // Gyro should be motionless here
-    SensorType[theGyro.port] = sensorGyro;
+    // Gyros should be motionless here
+    for(i=0;i<theGyros.count;i++)
+        SensorType[theGyros.port[i]] = sensorGyro;
 
     // Wait 1/2 sec
     wait1Msec(500);
 
     // Save the current system timer
     nSysTimeOffset = nSysTime;
+    lastTime       = nSysTime;
+
+#ifdef  GYRO_TIMING
+    GyroTimingReset( &theGyros.timing, theGyros.period );
+#endif
 
     // loop forever
     while(true)
         {
-        // get current gyro value (deg * 10)
-        gyro_value = SensorValue[theGyro.port];
+        GyroTimingStart( &theGyros.timing );
 
         // Filter drift when not moving
-        // check this every 250mS
-        if( (nSysTime - nSysTimeOffset) > 250 )
+        // check this every drift window, advancing by the window rather
+        // than to now keeps the average window exact at any period
+        driftCheck = (nSysTime - nSysTimeOffset) >= theGyros.drift_window;
+        if( driftCheck )
+            {
+            nSysTimeOffset += theGyros.drift_window;
+
+            // fallen more than a window behind, start again from now
+            if( (nSysTime - nSysTimeOffset) >= theGyros.drift_window )
+                nSysTimeOffset = nSysTime;
+            }
+
+        next = (theGyros.sequence + 1) & 1;
+        dt   = nSysTime - lastTime;
+
+        // one pass over all the gyros
+        for(i=0;i<theGyros.count;i++)
             {
-            if( abs( gyro_value - lastDriftGyro ) < GYRO_DRIFT_THRESHOLD )
-                theGyro.drift_error += (lastDriftGyro - gyro_value);
+            // hot reinit, disable the gyro so the firmware recalibrates
+            if( theGyros.recal_request[i] )
+                {
+                theGyros.recal_request[i] = false;
+                theGyros.recal_time[i]    = nSysTime + GYRO_REINIT_TIME;
+                SensorType[theGyros.port[i]] = sensorNone;
+                }
+
+            if( theGyros.recal_time[i] != 0 )
+                {
+                if( nSysTime < theGyros.recal_time[i] )
+                    {
+                    // keep publishing the last heading
+                    theGyros.sample[next].angle[i]     = theGyros.old_angle[i];
+                    theGyros.sample[next].abs_angle[i] = theGyros.abs_angle[i];
+                    theGyros.sample[next].delta[i]     = 0;
+                    theGyros.sample[next].valid[i]     = true;
+                    theGyros.sample[next].recal[i]     = true;
+                    continue;
+                    }
+
+                // firmware restarts from 0 and reads 0 until its calibration
+                // is done, carry the held heading over as an offset
+                SensorType[theGyros.port[i]] = sensorGyro;
+                theGyros.recal_time[i]    = 0;
+                theGyros.recal_end[i]     = nSysTime + GYRO_FW_CAL_TIME;
+                theGyros.offset[i]        = theGyros.old_angle[i];
+                GyroDriftReset( i );
+                }
+
+            // the heading is still held until the firmware has calibrated
+            if( theGyros.recal_end[i] != 0 && nSysTime >= theGyros.recal_end[i] )
+                theGyros.recal_end[i] = 0;
+            theGyros.sample[next].recal[i] = (theGyros.recal_end[i] != 0);
+
+            // get current gyro value (deg * 10)
+            gyro_value = SensorValue[theGyros.port[i]];
+#if GYRO_P_SIGN < 0
+            // gyro is upside down
+            gyro_value = -gyro_value;
+#endif
+
+            if( theGyros.drift_mode == kGyroDriftEstimator )
+                {
+                // change this pass, allowing for the firmware wrap at +/- 3600
+                d = gyro_value - theGyros.last_value[i];
+                theGyros.last_value[i] = gyro_value;
+                if( d > 1800 )
+                    d -= 3600;
+                if( d < -1800 )
+                    d += 3600;
+
+                // average the change over windows where the robot is still
+                if( abs(d) >= GYRO_EST_STILL_STEP )
+                    {
+                    theGyros.still_sum[i]  = 0;
+                    theGyros.still_time[i] = 0;
+                    }
+                else
+                    {
+                    theGyros.still_sum[i]  += d;
+                    theGyros.still_time[i] += dt;
+
+                    if( theGyros.still_time[i] >= GYRO_EST_WINDOW )
+                        {
+                        // one divide per window, the drift rate is what is left
+                        if( abs(theGyros.still_sum[i]) <= GYRO_EST_STILL_COUNT )
+                            {
+                            e = (theGyros.still_sum[i] << GYRO_FINE_SHIFT) / theGyros.still_time[i];
+                            theGyros.bias_q[i] += (e - theGyros.bias_q[i]) >> GYRO_EST_BIAS_SHIFT;
+                            }
+                        theGyros.still_sum[i]  = 0;
+                        theGyros.still_time[i] = 0;
+                        }
+                    }
+
+                // remove the drift whether moving or not
+                theGyros.drift_q[i] -= theGyros.bias_q[i] * dt;
+                if( theGyros.drift_q[i] >= GYRO_EST_DRIFT_WRAP )
+                    theGyros.drift_q[i] -= GYRO_EST_DRIFT_WRAP;
+                if( theGyros.drift_q[i] <= -GYRO_EST_DRIFT_WRAP )
+                    theGyros.drift_q[i] += GYRO_EST_DRIFT_WRAP;
+                }
+            else
+            if( driftCheck )
+                {
+                if( abs( gyro_value - theGyros.lastDriftGyro[i] ) < theGyros.drift_threshold )
+                    theGyros.drift_error[i] += (theGyros.lastDriftGyro[i] - gyro_value);
+
+                theGyros.lastDriftGyro[i] = gyro_value;
+                }
+
+            // Create angle, remove drift, add any heading carried over
+            angle = GyroAngleFromValue( gyro_value + theGyros.drift_error[i] ) + theGyros.offset[i];
+            if( theGyros.drift_mode == kGyroDriftEstimator )
+                angle += GyroAngleFromFine( theGyros.drift_q[i] );
+
+            // normalize into the range 0 - 360
+            while( angle < 0 )
+                angle += GYRO_ANGLE_360;
+            while( angle >= GYRO_ANGLE_360 )
+                angle -= GYRO_ANGLE_360;
+
+            // store for others
+            theGyros.sample[next].angle[i] = angle;
+
+            // work out change from last time
+            delta_angle = angle - theGyros.old_angle[i];
+            theGyros.old_angle[i] = angle;
+
+            // fix rollover
+            if(delta_angle > GYRO_ANGLE_180)
+              delta_angle -= GYRO_ANGLE_360;
+            if(delta_angle < -GYRO_ANGLE_180)
+              delta_angle += GYRO_ANGLE_360;
+
+            // store absolute angle
+            theGyros.abs_angle[i] = theGyros.abs_angle[i] + delta_angle;
+            theGyros.sample[next].abs_angle[i] = theGyros.abs_angle[i];
+            theGyros.sample[next].delta[i]     = delta_angle;
 
-            lastDriftGyro = gyro_value;
+            // We can use the angle
+            theGyros.sample[next].valid[i] = true;
 
-            nSysTimeOffset = nSysTime;
+#ifdef  GYRO_TELEMETRY
+            e = theGyros.drift_error[i] + (theGyros.drift_q[i] >> GYRO_FINE_SHIFT);
+            GyroTelemetryPut( &theGyros.telemetry, i | kGyroTeleValid, gyro_value, gyro_value + e, e,
+                              GyroAngleToCenti( theGyros.abs_angle[i] ) );
+#endif
             }
 
-        // Create float angle, remove offset
-        angle = (gyro_value + theGyro.drift_error)  / 10.0;
+        // publish the whole pass at once
+        theGyros.sample[next].time = nSysTime;
+        theGyros.sample[next].dt   = dt;
+        lastTime = nSysTime;
+#ifdef  GYRO_ODOMETRY
+        GyroOdometryUpdate( next );
+#endif
+        theGyros.sequence++;
+        GyroHistoryPush();
+#ifdef  GYRO_TURN
+        GyroTurnUpdate();
+#endif
+
+        GyroTimingEnd( &theGyros.timing );
+
+        // Delay
+        wait1Msec( theGyros.period );
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Start calibrating a gyro on the raw backend                     */
+/** @param[in] gyro the gyro handle                                            */
+/*-----------------------------------------------------------------------------*/
+
+void
+GyroRawCalStart( tGyro gyro )
+{
+    theGyros.cal_n[gyro]      = 0;
+    theGyros.cal_first[gyro]  = 0;
+    theGyros.cal_acc[gyro]    = 0;
+    theGyros.cal_sq[gyro]     = 0;
+    theGyros.recal_time[gyro] = nSysTime + GYRO_RAW_SETTLE;
+    GyroDriftReset( gyro );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     One calibration sample for a gyro on the raw backend            */
+/** @param[in] gyro the gyro handle                                            */
+/** @param[in] raw the analog value                                            */
+/** @param[in] hot true on a hot reinit, the old bias is still in use         */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The adaptive calibration from gyroSim.c, stops once the variance says
+ *   the bias is known well enough.  recal_time is cleared when done.
+ *
+ *   On a hot reinit the old bias shows when the robot moves, the samples
+ *   so far are dropped and calibration starts again.
+ */
+void
+GyroRawCalSample( tGyro gyro, int raw, bool hot )
+{
+    long    n;
+    float   dev;
+    long    bias;
+
+    if( hot && abs( raw - theGyros.raw_bias[gyro] ) > GYRO_RAW_STILL )
+        {
+        theGyros.cal_n[gyro]   = 0;
+        theGyros.cal_acc[gyro] = 0;
+        theGyros.cal_sq[gyro]  = 0;
+        return;
+        }
+
+    if( theGyros.cal_n[gyro] == 0 )
+        theGyros.cal_first[gyro] = raw;
+
+    dev = raw - theGyros.cal_first[gyro];
+    theGyros.cal_acc[gyro] += dev;
+    theGyros.cal_sq[gyro]  += dev * dev;
+    n = ++theGyros.cal_n[gyro];
+
+    // converged when variance / n < 1/tolerance^2
+    if( n < GYRO_RAW_CAL_MAX &&
+        (n < GYRO_RAW_CAL_MIN ||
+         (n * theGyros.cal_sq[gyro] - theGyros.cal_acc[gyro] * theGyros.cal_acc[gyro]) *
+         (GYRO_RAW_CAL_TOLERANCE * GYRO_RAW_CAL_TOLERANCE) > (float)n * n * n) )
+        return;
+
+    // round to the nearest count so the jitter band is centred on the bias,
+    // gyroSim truncates and integrates more noise on one side than the other
+    bias = theGyros.cal_first[gyro] * 1024L + (long)(theGyros.cal_acc[gyro] * 1024.0 / n);
+    theGyros.raw_bias[gyro]   = (bias + 512) / 1024;
+    theGyros.raw_small[gyro]  = bias - theGyros.raw_bias[gyro] * 1024L;
+    theGyros.recal_time[gyro] = 0;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief  Task that reads the raw gyro and calculates the angle of rotation  */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The single stage alternative to GyroTask.  Bias removal, jitter
+ *   rejection and integration are done as in gyroSim.c, but the heading is
+ *   kept in counts * mS so there is no intermediate deg * 10 value to
+ *   quantize, clip and unwrap.  The analog port is read every 1mS, results
+ *   are published every period.
+ *
+ *   With kGyroDriftEstimator the bias keeps being refined from samples
+ *   inside the jitter band, otherwise it is fixed at calibration.
+ */
+task GyroRawTask()
+{
+    int         raw;
+    int         delta;
+    long        dt;
+    long        lastTime;
+    long        lastPublish;
+    bool        publish;
+    int         cur;
+    int         next;
+    tGyro       i;
+    tGyroAngle  angle;
+    tGyroAngle  abs_angle;
+    long        bias;
+    bool        hot;
+
+    next = (theGyros.sequence + 1) & 1;
+
+    for(i=0;i<theGyros.count;i++)
+        {
+        // Gyro readings invalid
+        theGyros.sample[next].valid[i]     = false;
+        theGyros.sample[next].angle[i]     = 0;
+        theGyros.sample[next].abs_angle[i] = 0;
+        theGyros.sample[next].delta[i]     = 0;
+
+        // clear angles
+        theGyros.abs_angle[i]     = 0;
+        theGyros.old_angle[i]     = 0;
+        theGyros.offset[i]        = 0;
+        theGyros.raw_acc[i]       = 0;
+        theGyros.raw_cycles[i]    = 0;
+        theGyros.raw_turns[i]     = 0;
+        theGyros.recal_request[i] = false;
+
+        // we read the port, not the firmware
+        SensorType[theGyros.port[i]] = sensorAnalog;
+
+        GyroRawCalStart( i );
+        }
+
+    // publish
+    theGyros.sample[next].time = nSysTime;
+    theGyros.sample[next].dt   = 0;
+    theGyros.sequence++;
+
+    // nothing from before the restart
+    theGyros.hist_head  = 0;
+#ifdef  GYRO_ODOMETRY
+    theGyros.odometry.primed = false;
+#endif
+
+    lastTime    = nSysTime;
+    lastPublish = nSysTime;
+
+#ifdef  GYRO_TIMING
+    GyroTimingReset( &theGyros.timing, 1 );
+#endif
+
+    // loop forever
+    while(true)
+        {
+        GyroTimingStart( &theGyros.timing );
+
+        // time since the last sample, more than 1mS if we were run late
+        dt       = nSysTime - lastTime;
+        lastTime = nSysTime;
+
+        publish = (nSysTime - lastPublish) >= theGyros.period;
+        cur     = theGyros.sequence & 1;
+        next    = (theGyros.sequence + 1) & 1;
+
+        // one pass over all the gyros
+        for(i=0;i<theGyros.count;i++)
+            {
+            // hot reinit, measure the bias again
+            if( theGyros.recal_request[i] )
+                {
+                theGyros.recal_request[i] = false;
+                GyroRawCalStart( i );
+                }
+
+            raw = SensorValue[theGyros.port[i]];
+
+            // calibrating with a heading already there is a hot reinit
+            hot = (theGyros.recal_time[i] != 0) && theGyros.sample[cur].valid[i];
+
+            if( theGyros.recal_time[i] != 0 && nSysTime >= theGyros.recal_time[i] )
+                GyroRawCalSample( i, raw, hot );
+
+            // a hot reinit integrates with the old bias until the new one is ready
+            if( theGyros.recal_time[i] == 0 || hot )
+                {
+                // remove bias
+                delta = raw - theGyros.raw_bias[i];
+
+                // ignore small changes
+                if( (delta < -theGyros.raw_jitter) || (delta > theGyros.raw_jitter) )
+                    {
+                    // integrate, the sample stands for all the elapsed time
+                    theGyros.raw_acc[i] += (long)delta * dt * GYRO_P_SIGN;
+
+                    // compensate for error in bias, once every 1024mS integrated
+                    theGyros.raw_cycles[i] += dt;
+                    while( theGyros.raw_cycles[i] >= 1024 )
+                        {
+                        theGyros.raw_cycles[i] -= 1024;
+                        theGyros.raw_acc[i]    -= theGyros.raw_small[i] * GYRO_P_SIGN;
+                        }
+
+                    // keep one turn, count the rest, a late tick can add several
+                    while( theGyros.raw_acc[i] >= GYRO_RAW_360 )
+                        {
+                        theGyros.raw_acc[i] -= GYRO_RAW_360;
+                        theGyros.raw_turns[i]++;
+                        }
+                    while( theGyros.raw_acc[i] < 0 )
+                        {
+                        theGyros.raw_acc[i] += GYRO_RAW_360;
+                        theGyros.raw_turns[i]--;
+                        }
+                    }
 
-        // normalize into the range 0 - 360
-        if( angle < 0 )
-            angle += 360;
+                if( theGyros.drift_mode == kGyroDriftEstimator )
+                    {
+                    if( (delta < -GYRO_RAW_STILL) || (delta > GYRO_RAW_STILL) )
+                        {
+                        // motion, start looking for a quiet window again
+                        theGyros.still_sum[i]  = 0;
+                        theGyros.still_time[i] = 0;
+                        }
+                    else
+                        {
+                        // quiet samples, their mean is the bias error in counts
+                        theGyros.still_sum[i] += delta;
+                        if( ++theGyros.still_time[i] >= GYRO_RAW_REFINE )
+                            {
+                            // GYRO_RAW_REFINE is 1024 so the sum is the fraction,
+                            // more than a count off is slow motion, not bias
+                            if( abs(theGyros.still_sum[i]) <= 1024 )
+                                {
+                                theGyros.raw_small[i] += (theGyros.still_sum[i] - theGyros.raw_small[i]) >> GYRO_EST_BIAS_SHIFT;
 
-        // store in struct for others
-        theGyro.angle = angle;
+                                bias = theGyros.raw_bias[i] * 1024L + theGyros.raw_small[i];
+                                theGyros.raw_bias[i]  = (bias + 512) / 1024;
+                                theGyros.raw_small[i] = bias - theGyros.raw_bias[i] * 1024L;
+                                }
 
-        // work out change from last time
-        delta_angle = angle - old_angle;
-        old_angle   = angle;
+                            theGyros.still_sum[i]  = 0;
+                            theGyros.still_time[i] = 0;
+                            }
+                        }
+                    }
+                }
 
-        // fix rollover
-        if(delta_angle > 180)
-          delta_angle -= 360;
-        if(delta_angle < -180)
-          delta_angle += 360;
+            if( !publish )
+                continue;
 
-        // store absolute angle
-        theGyro.abs_angle = theGyro.abs_angle + delta_angle;
+            // angles come straight from the integrator
+            angle     = GyroAngleFromRaw( theGyros.raw_acc[i] );
+            abs_angle = theGyros.raw_turns[i] * GYRO_ANGLE_360 + angle;
 
-        // We can use the angle
-        theGyro.valid = true;
+            theGyros.sample[next].angle[i]     = angle;
+            theGyros.sample[next].abs_angle[i] = abs_angle;
+            theGyros.sample[next].delta[i]     = abs_angle - theGyros.abs_angle[i];
+            theGyros.old_angle[i] = angle;
+            theGyros.abs_angle[i] = abs_angle;
+
+            // valid once calibrated, a hot reinit stays valid
+            theGyros.sample[next].valid[i] = (theGyros.recal_time[i] == 0) || theGyros.sample[cur].valid[i];
+            theGyros.sample[next].recal[i] = hot && (theGyros.recal_time[i] != 0);
+
+#ifdef  GYRO_TELEMETRY
+            GyroTelemetryPut( &theGyros.telemetry,
+                              i | kGyroTeleRaw | (theGyros.sample[next].valid[i] ? kGyroTeleValid : 0),
+                              raw, raw - theGyros.raw_bias[i],
+                              theGyros.raw_bias[i] * 8 + theGyros.raw_small[i] / 128,
+                              GyroAngleToCenti( abs_angle ) );
+#endif
+            }
+
+        if( publish )
+            {
+            // publish the whole pass at once
+            theGyros.sample[next].time = nSysTime;
+            theGyros.sample[next].dt   = nSysTime - lastPublish;
+            lastPublish = nSysTime;
+#ifdef  GYRO_ODOMETRY
+            GyroOdometryUpdate( next );
+#endif
+            theGyros.sequence++;
+            GyroHistoryPush();
+#ifdef  GYRO_TURN
+            GyroTurnUpdate();
+#endif
+            }
+
+        GyroTimingEnd( &theGyros.timing );
 
         // Delay
-        wait1Msec( 20 );
+        wait1Msec( 1 );
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Start the polling task for the backend in use                   */
+/*-----------------------------------------------------------------------------*/
+
+void
+GyroTaskStart()
+{
+    stopTask( GyroTask );
+    stopTask( GyroRawTask );
+
+#ifdef  GYRO_TURN
+    // the heading is gone until the gyros calibrate, so is any turn on it
+    theGyros.turn.request = false;
+    GyroTurnHalt( &theGyros.turn );
+#endif
+
+    if( theGyros.backend == kGyroBackendRaw )
+        startTask( GyroRawTask );
+    else
+        startTask( GyroTask );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Add a gyro to the table                                         */
+/** @param[in] port the analog port that the gyro is connected to              */
+/** @returns   handle for the new gyro                                         */
+/*-----------------------------------------------------------------------------*/
+tGyro
+GyroTableAdd( tSensors port )
+{
+    tGyro   gyro = theGyros.count;
+    int     b;
+
+    theGyros.port[gyro]          = port;
+    theGyros.abs_angle[gyro]     = 0;
+    theGyros.offset[gyro]        = 0;
+    theGyros.recal_request[gyro] = false;
+    theGyros.recal_time[gyro]    = 0;
+    theGyros.recal_end[gyro]     = 0;
+
+    for(b=0;b<2;b++)
+        {
+        theGyros.sample[b].valid[gyro]     = false;
+        theGyros.sample[b].recal[gyro]     = false;
+        theGyros.sample[b].angle[gyro]     = 0;
+        theGyros.sample[b].abs_angle[gyro] = 0;
+        theGyros.sample[b].delta[gyro]     = 0;
         }
+
+    // the polling task may be running, only let it see a complete entry
+    theGyros.count++;
+
+    return( gyro );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Give the run time settings their defaults, only the first time  */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Called by GyroInit and by the set functions so they can be used before
+ *   GyroInit without GyroInit then undoing them.
+ */
+void
+GyroTuneDefaults()
+{
+    if( theGyros.tuned )
+        return;
+
+    theGyros.drift_threshold = GYRO_DRIFT_THRESHOLD;
+    theGyros.drift_window    = GYRO_DRIFT_WINDOW;
+    theGyros.raw_jitter      = GYRO_RAW_JITTER;
+    theGyros.tuned           = true;
 }
 
 /*-----------------------------------------------------------------------------*/
 /** @brief     Initialize the Gyro                                             */
 /** @param[in] port the analog port that the gyro is connected to              */
+/** @param[in] period the polling period in mS                                 */
+/** @param[in] backend kGyroBackendFirmware or kGyroBackendRaw                 */
 /*-----------------------------------------------------------------------------*/
+/** @details
+ *   Any gyros previously added are removed, this gyro becomes gyro 0.
+ *   The period applies to all gyros and is limited to GYRO_PERIOD_MIN to
+ *   GYRO_PERIOD_MAX.  The raw backend samples every 1mS whatever the
+ *   period, which then only sets how often results are published.
+ */
 void
-GyroInit( tSensors port = in1  )
+GyroInit( tSensors port = in1, int period = GYRO_PERIOD_DEFAULT, int backend = kGyroBackendFirmware )
 {
-    theGyro.port  = port;
-    theGyro.valid = false;
-    theGyro.angle = 0.0;
-    theGyro.abs_angle = 0.0;
+    if( period < GYRO_PERIOD_MIN )
+        period = GYRO_PERIOD_MIN;
+    if( period > GYRO_PERIOD_MAX )
+        period = GYRO_PERIOD_MAX;
+
+    theGyros.period  = period;
+    theGyros.count   = 0;
+    theGyros.backend = backend;
+    theGyros.debug_shown = -2;
 
-    startTask( GyroTask );
+#ifdef  GYRO_TELEMETRY
+    GyroTelemetryReset( &theGyros.telemetry );
+#endif
+
+    if( theGyros.drift_mode != kGyroDriftEstimator )
+        theGyros.drift_mode = kGyroDriftThreshold;
+    GyroTuneDefaults();
+    GyroTableAdd( port );
+
+    GyroTaskStart();
 }
 
 /*-----------------------------------------------------------------------------*/
 /** @brief Reinitialize the gyro task                                          */
+/** @param[in] hot true to keep the heading while recalibrating                */
 /*-----------------------------------------------------------------------------*/
 /** @details
  *   Cause the gyro to be reinitialized by stopping and then restarting the
- *   polling task
+ *   polling task, all gyros are recalibrated
+ *
+ *   A hot reinit returns at once and leaves the task running, valid stays
+ *   true and the snapshot shows recalibrating until it is over.  The robot
+ *   must not move until GyroRecalDoneGet is true.  Meanwhile the turn
+ *   controller stops and must be asked again, and odometry pauses.  The
+ *   firmware backend holds the last heading while the firmware calibrates
+ *   again and then continues from it.  The raw backend keeps integrating
+ *   with the old bias and changes to the new one once it has been measured
+ *   with the robot still.
  */
 void
-GyroReinit()
+GyroReinit( bool hot = false )
 {
-    stopTask( GyroTask );
-    startTask( GyroTask );
+    tGyro   i;
+
+    if( hot )
+        {
+        for(i=0;i<theGyros.count;i++)
+            theGyros.recal_request[i] = true;
+        }
+    else
+        GyroTaskStart();
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Select the drift correction                                     */
+/** @param[in] mode kGyroDriftThreshold or kGyroDriftEstimator                 */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Applies to all gyros, call before GyroInit or expect a small step in
+ *   heading when the correction built up so far is dropped.
+ */
+void
+GyroDriftModeSet( int mode )
+{
+    tGyro   i;
+
+    theGyros.drift_mode = mode;
+
+    for(i=0;i<theGyros.count;i++)
+        GyroDriftReset( i );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Tune the threshold drift correction                             */
+/** @param[in] threshold changes smaller than this in a window are drift       */
+/** @param[in] window mS between drift checks                                  */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The defaults are GYRO_DRIFT_THRESHOLD and GYRO_DRIFT_WINDOW, a longer
+ *   window or lower threshold lets less of a slow turn be taken as drift
+ *   but removes less of the drift.  Takes effect at the next drift check,
+ *   gyroSweep on the host is the way to choose new values.
+ */
+void
+GyroDriftParamsSet( int threshold = GYRO_DRIFT_THRESHOLD, int window = GYRO_DRIFT_WINDOW )
+{
+    if( window < 1 )
+        window = 1;
+    if( window > GYRO_DRIFT_WINDOW_MAX )
+        window = GYRO_DRIFT_WINDOW_MAX;
+
+    GyroTuneDefaults();
+    theGyros.drift_threshold = threshold;
+    theGyros.drift_window    = window;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Tune the raw backend dead band                                  */
+/** @param[in] jitter changes from the bias this small are noise, counts       */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The default is GYRO_RAW_JITTER, the same as the firmware.  Only the raw
+ *   backend reads it, it is the one dead band that can be changed on the
+ *   robot since the firmware keeps its own.  Takes effect at once.
+ */
+void
+GyroRawJitterSet( int jitter = GYRO_RAW_JITTER )
+{
+    if( jitter < 0 )
+        jitter = 0;
+    if( jitter > GYRO_RAW_JITTER_MAX )
+        jitter = GYRO_RAW_JITTER_MAX;
+
+    GyroTuneDefaults();
+    theGyros.raw_jitter = jitter;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Add another gyro                                                */
+/** @param[in] port the analog port that the gyro is connected to              */
+/** @returns   handle for the gyro or -1 if the table is full                  */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Call after GyroInit, the polling task is restarted so all gyros are
+ *   recalibrated together.  Add all gyros before the robot moves.  Returns
+ *   -1 if GyroInit has not been called, there is no period or tuning yet.
+ */
+tGyro
+GyroAdd( tSensors port )
+{
+    tGyro   gyro;
+
+    if( theGyros.period == 0 || theGyros.count >= kMaxGyros )
+        return( -1 );
+
+    gyro = GyroTableAdd( port );
+    GyroReinit();
+
+    return( gyro );
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief     Get a gyro angle in degrees                                     */
+/** @param[in] gyro the gyro handle                                            */
+/** @returns   gyro angle in the range 0 to 360 deg                            */
+/*-----------------------------------------------------------------------------*/
+float
+GyroAngleDegGetN( tGyro gyro )
+{
+    return( GyroAngleToDeg( theGyros.sample[ theGyros.sequence & 1 ].angle[gyro] ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Get a gyro angle in radians                                     */
+/** @param[in] gyro the gyro handle                                            */
+/** @returns   gyro angle in the range 0 to 2PI radians                        */
+/*-----------------------------------------------------------------------------*/
+float
+GyroAngleRadGetN( tGyro gyro )
+{
+    return( GyroAngleToRad( theGyros.sample[ theGyros.sequence & 1 ].angle[gyro] ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Get a gyro absolute angle                                       */
+/** @param[in] gyro the gyro handle                                            */
+/** @returns   the accumuated absolute gyro angle in degrees                   */
+/*-----------------------------------------------------------------------------*/
+float
+GyroAngleAbsGetN( tGyro gyro )
+{
+    return( GyroAngleToDeg( theGyros.sample[ theGyros.sequence & 1 ].abs_angle[gyro] ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Get the validity of a gyro                                      */
+/** @param[in] gyro the gyro handle                                            */
+/** @returns   true if the gyro is initialized and returning valid data        */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroValidGetN( tGyro gyro )
+{
+    return( theGyros.sample[ theGyros.sequence & 1 ].valid[gyro] );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Get whether a hot reinit of a gyro has finished                 */
+/** @param[in] gyro the gyro handle                                            */
+/** @returns   true once the robot may move again                              */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Also true when no hot reinit was asked for.  A request the polling task
+ *   has not taken yet counts as running.
+ */
+bool
+GyroRecalDoneGetN( tGyro gyro )
+{
+    return( !theGyros.recal_request[gyro] && !theGyros.sample[ theGyros.sequence & 1 ].recal[gyro] );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get a consistent copy of the state of a gyro                   */
+/** @param[in]  gyro the gyro handle                                           */
+/** @param[out] snap the snapshot                                              */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   All values come from the same pass of the polling task.  The task never
+ *   waits for readers, if it publishes a new pass while the copy is being
+ *   made the copy is simply taken again.
+ */
+void
+GyroSnapshotGetN( tGyro gyro, gyroSnapshot *snap )
+{
+    long        seq;
+    int         b;
+    bool        valid;
+    bool        recal;
+    tGyroAngle  angle;
+    tGyroAngle  abs_angle;
+    tGyroAngle  delta;
+    long        time;
+    long        dt;
+
+    do
+        {
+        seq       = theGyros.sequence;
+        b         = seq & 1;
+        valid     = theGyros.sample[b].valid[gyro];
+        recal     = theGyros.sample[b].recal[gyro];
+        angle     = theGyros.sample[b].angle[gyro];
+        abs_angle = theGyros.sample[b].abs_angle[gyro];
+        delta     = theGyros.sample[b].delta[gyro];
+        time      = theGyros.sample[b].time;
+        dt        = theGyros.sample[b].dt;
+        } while( seq != theGyros.sequence );
+
+    snap->valid         = valid;
+    snap->recalibrating = recal;
+    snap->angle         = GyroAngleToDeg( angle );
+    snap->abs_angle     = GyroAngleToDeg( abs_angle );
+    snap->rate          = (dt > 0) ? GyroAngleToDeg( delta ) * 1000.0 / dt : 0.0;
+    snap->time          = time;
+    snap->sequence      = seq;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get a consistent copy of the state of the gyro                 */
+/** @param[out] snap the snapshot                                              */
+/*-----------------------------------------------------------------------------*/
+void
+GyroSnapshotGet( gyroSnapshot *snap )
+{
+    GyroSnapshotGetN( 0, snap );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get a gyro absolute angle at a recent time                     */
+/** @param[in]  gyro the gyro handle                                           */
+/** @param[in]  time the nSysTime wanted                                       */
+/** @param[out] abs_angle the absolute angle in degrees at that time           */
+/** @returns    true if time is covered by the history                        */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Interpolates between the two passes either side of time, found by a
+ *   binary search of the history.  Times after the last pass get the last
+ *   pass.  Like GyroSnapshotGetN the task is never held up, if it writes
+ *   over an entry that was being used the search is done again.
+ */
+bool
+GyroAngleAbsAtN( tGyro gyro, long time, float *abs_angle )
+{
+    long        head;
+    long        lo, hi, mid;
+    int         k0, k1;
+    long        t0, t1;
+    tGyroAngle  a0, a1;
+
+    do
+        {
+        head = theGyros.hist_head;
+        if( head == 0 )
+            return( false );
+
+        // oldest and newest passes still in the history
+        lo = (head > GYRO_HISTORY_SIZE) ? head - GYRO_HISTORY_SIZE + 1 : 0;
+        hi = head - 1;
+
+        if( time < theGyros.hist_time[ lo & (GYRO_HISTORY_SIZE - 1) ] )
+            return( false );
+
+        // last pass at or before time
+        while( lo < hi )
+            {
+            mid = (lo + hi + 1) >> 1;
+            if( theGyros.hist_time[ mid & (GYRO_HISTORY_SIZE - 1) ] <= time )
+                lo = mid;
+            else
+                hi = mid - 1;
+            }
+
+        k0 = lo & (GYRO_HISTORY_SIZE - 1);
+        k1 = (lo + 1) & (GYRO_HISTORY_SIZE - 1);
+        t0 = theGyros.hist_time[k0];
+        a0 = theGyros.hist_abs[k0][gyro];
+        t1 = t0;
+        a1 = a0;
+        if( lo + 1 < head )
+            {
+            t1 = theGyros.hist_time[k1];
+            a1 = theGyros.hist_abs[k1][gyro];
+            }
+        } while( theGyros.hist_head - lo >= GYRO_HISTORY_SIZE );
+
+    *abs_angle = GyroAngleToDeg( a0 );
+    if( t1 > t0 )
+        *abs_angle += GyroAngleToDeg( a1 - a0 ) * (time - t0) / (t1 - t0);
+
+    return( true );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get a gyro angle at a recent time                              */
+/** @param[in]  gyro the gyro handle                                           */
+/** @param[in]  time the nSysTime wanted                                       */
+/** @param[out] angle the angle in the range 0 to 360 deg at that time        */
+/** @returns    true if time is covered by the history                        */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroAngleDegAtN( tGyro gyro, long time, float *angle )
+{
+    float   a;
+
+    if( !GyroAngleAbsAtN( gyro, time, &a ) )
+        return( false );
+
+    a = a - 360.0 * (long)( a / 360.0 );
+    if( a < 0 )
+        a += 360.0;
+
+    *angle = a;
+    return( true );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the average gyro rate between two recent times             */
+/** @param[in]  gyro the gyro handle                                           */
+/** @param[in]  from start of the interval, nSysTime                           */
+/** @param[in]  to end of the interval, nSysTime                               */
+/** @param[out] rate average angular rate in deg/sec                           */
+/** @returns    true if both times are covered by the history                 */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroRateAvgN( tGyro gyro, long from, long to, float *rate )
+{
+    float   a0, a1;
+
+    if( to <= from || !GyroAngleAbsAtN( gyro, from, &a0 ) || !GyroAngleAbsAtN( gyro, to, &a1 ) )
+        return( false );
+
+    *rate = (a1 - a0) * 1000.0 / (to - from);
+    return( true );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the gyro absolute angle at a recent time                   */
+/** @param[in]  time the nSysTime wanted                                       */
+/** @param[out] abs_angle the absolute angle in degrees at that time           */
+/** @returns    true if time is covered by the history                        */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroAngleAbsAt( long time, float *abs_angle )
+{
+    return( GyroAngleAbsAtN( 0, time, abs_angle ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the gyro angle at a recent time                            */
+/** @param[in]  time the nSysTime wanted                                       */
+/** @param[out] angle the angle in the range 0 to 360 deg at that time        */
+/** @returns    true if time is covered by the history                        */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroAngleDegAt( long time, float *angle )
+{
+    return( GyroAngleDegAtN( 0, time, angle ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the average gyro rate between two recent times             */
+/** @param[in]  from start of the interval, nSysTime                           */
+/** @param[in]  to end of the interval, nSysTime                               */
+/** @param[out] rate average angular rate in deg/sec                           */
+/** @returns    true if both times are covered by the history                 */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroRateAvg( long from, long to, float *rate )
+{
+    return( GyroRateAvgN( 0, from, to, rate ) );
+}
+
+#ifdef  GYRO_ODOMETRY
+/*-----------------------------------------------------------------------------*/
+/** @brief      Start tracking the robot position                              */
+/** @param[in]  left quad encoder on the left side                             */
+/** @param[in]  right quad encoder on the right side                           */
+/** @param[in]  scale distance moved per encoder count, in any unit            */
+/** @param[in]  gyro the gyro giving the heading                               */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Call after GyroInit or GyroAdd.  Both encoders must count up when the
+ *   robot drives forwards.  The pose starts at 0, 0 and x is along the gyro
+ *   heading of 0.  The polling task moves the pose on every pass, the
+ *   heading is the gyro angle itself.
+ */
+void
+GyroOdometryInit( tSensors left, tSensors right, float scale, tGyro gyro = 0 )
+{
+    // the task leaves it alone until it is set up
+    theGyros.odometry.enabled = false;
+    GyroOdometryReset( &theGyros.odometry, left, right, scale, gyro );
+    theGyros.odometry.enabled = true;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Move the robot position                                        */
+/** @param[in]  x new position along heading 0                                 */
+/** @param[in]  y new position along heading 90 deg                            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Takes effect on the next pass of the polling task.
+ */
+void
+GyroPoseSet( float x, float y )
+{
+    theGyros.odometry.set_x = x / theGyros.odometry.scale * (1L << GYRO_ODO_SHIFT);
+    theGyros.odometry.set_y = y / theGyros.odometry.scale * (1L << GYRO_ODO_SHIFT);
+    theGyros.odometry.set_request = true;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the robot position and heading from one pass               */
+/** @param[out] pose the position                                              */
+/*-----------------------------------------------------------------------------*/
+void
+GyroPoseGet( gyroPose *pose )
+{
+    long        seq;
+    int         b;
+    tGyro       g = theGyros.odometry.gyro;
+    bool        valid;
+    tGyroAngle  angle;
+    long        x, y;
+    long        time;
+
+    do
+        {
+        seq   = theGyros.sequence;
+        b     = seq & 1;
+        valid = theGyros.sample[b].valid[g];
+        angle = theGyros.sample[b].angle[g];
+        x     = theGyros.sample[b].pose_x;
+        y     = theGyros.sample[b].pose_y;
+        time  = theGyros.sample[b].time;
+        } while( seq != theGyros.sequence );
+
+    pose->valid    = valid && theGyros.odometry.enabled;
+    pose->x        = x * (theGyros.odometry.scale / (1L << GYRO_ODO_SHIFT));
+    pose->y        = y * (theGyros.odometry.scale / (1L << GYRO_ODO_SHIFT));
+    pose->theta    = GyroAngleToRad( angle );
+    pose->time     = time;
+    pose->sequence = seq;
+}
+#endif
+
+#ifdef  GYRO_TURN
+/*-----------------------------------------------------------------------------*/
+/** @brief      Set up the turn controller                                     */
+/** @param[in]  left left drive motor                                          */
+/** @param[in]  right right drive motor                                        */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Call after GyroInit.  Both motors must drive the robot forwards with
+ *   positive power, for more than one motor a side slave the others.  The
+ *   controller uses gyro 0 and does nothing until GyroTurnTo or
+ *   GyroHeadingHold.
+ */
+void
+GyroTurnInit( tMotor left, tMotor right )
+{
+    theGyros.turn.mode     = kGyroTurnOff;
+    theGyros.turn.request  = false;
+    theGyros.turn.done     = false;
+    theGyros.turn.motor[0] = left;
+    theGyros.turn.motor[1] = right;
+
+    theGyros.turn.params.vmax           = 240;
+    theGyros.turn.params.amax           = 1200;
+    theGyros.turn.params.shape          = kGyroProfileSCurve;
+    theGyros.turn.params.kv             = 0.35;
+    theGyros.turn.params.ka             = 0.04;
+    theGyros.turn.params.ks             = 16;
+    theGyros.turn.params.kp             = 5.0;
+    theGyros.turn.params.kd             = 0.5;
+    theGyros.turn.params.tolerance      = 1.0;
+    theGyros.turn.params.rate_tolerance = 10;
+    theGyros.turn.params.settle         = 100;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the turn controller settings                               */
+/** @param[out] p copy of the settings                                         */
+/*-----------------------------------------------------------------------------*/
+void
+GyroTurnParamsGet( gyroTurnParams *p )
+{
+    memcpy( p, &theGyros.turn.params, sizeof(gyroTurnParams) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Change the turn controller settings                            */
+/** @param[in]  p the new settings, used from the next turn                    */
+/*-----------------------------------------------------------------------------*/
+void
+GyroTurnParamsSet( gyroTurnParams *p )
+{
+    memcpy( &theGyros.turn.params, p, sizeof(gyroTurnParams) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Ask the polling task for a new controller mode                 */
+/*-----------------------------------------------------------------------------*/
+void
+GyroTurnRequest( int mode, float target )
+{
+    theGyros.turn.done           = false;
+    theGyros.turn.request_mode   = mode;
+    theGyros.turn.request_target = target;
+    theGyros.turn.request        = true;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Turn to a heading and then hold it                             */
+/** @param[in]  angle the absolute angle wanted in degrees                     */
+/*-----------------------------------------------------------------------------*/
+void
+GyroTurnTo( float angle )
+{
+    GyroTurnRequest( kGyroTurnProfile, angle );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Turn through an angle and then hold the heading                */
+/** @param[in]  angle degrees to turn, positive is left                        */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Measured from the last target if the controller is running, so errors
+ *   do not add up over a run of turns, otherwise from the heading now.
+ */
+void
+GyroTurnBy( float angle )
+{
+    if( theGyros.turn.mode != kGyroTurnOff )
+        GyroTurnTo( theGyros.turn.target + angle );
+    else
+        GyroTurnTo( GyroAngleAbsGetN( 0 ) + angle );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Hold a heading without a profile                               */
+/** @param[in]  angle the absolute angle to hold in degrees                    */
+/*-----------------------------------------------------------------------------*/
+void
+GyroHeadingHold( float angle )
+{
+    GyroTurnRequest( kGyroTurnHold, angle );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Stop the turn controller and the motors                        */
+/*-----------------------------------------------------------------------------*/
+void
+GyroTurnStop()
+{
+    GyroTurnRequest( kGyroTurnOff, 0 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get whether the last turn has finished                         */
+/** @returns    true once on target and settled                                */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroTurnDoneGet()
+{
+    return( theGyros.turn.done && !theGyros.turn.request );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Wait for the last turn to finish                               */
+/** @param[in]  timeout give up after this many mS                             */
+/** @returns    true if the turn finished                                      */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroTurnWait( long timeout = 3000 )
+{
+    long    end = nSysTime + timeout;
+
+    while( !GyroTurnDoneGet() )
+        {
+        if( nSysTime >= end )
+            return( false );
+        wait1Msec( 10 );
+        }
+
+    return( true );
+}
+#endif
+
 /*-----------------------------------------------------------------------------*/
 /** @brief    Get the current gyro angle in degrees                            */
 /** @returns  gyro angle in the range 0 to 360 deg                             */
@@ -212,7 +1655,7 @@ GyroReinit()
 float
 GyroAngleDegGet()
 {
-    return( theGyro.angle );
+    return( GyroAngleDegGetN( 0 ) );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -222,7 +1665,7 @@ GyroAngleDegGet()
 float
 GyroAngleRadGet()
 {
-    return( theGyro.angle / 180.0 * PI );
+    return( GyroAngleRadGetN( 0 ) );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -232,7 +1675,7 @@ GyroAngleRadGet()
 float
 GyroAngleAbsGet()
 {
-    return( theGyro.abs_angle );
+    return( GyroAngleAbsGetN( 0 ) );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -242,8 +1685,85 @@ GyroAngleAbsGet()
 bool
 GyroValidGet()
 {
-    return( theGyro.valid );
+    return( GyroValidGetN( 0 ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief    Get whether a hot reinit has finished on every gyro              */
+/** @returns  true once the robot may move again                              */
+/*-----------------------------------------------------------------------------*/
+bool
+GyroRecalDoneGet()
+{
+    tGyro   i;
+
+    for(i=0;i<theGyros.count;i++)
+        {
+        if( !GyroRecalDoneGetN( i ) )
+            return( false );
+        }
+
+    return( true );
+}
+
+#ifdef  GYRO_TIMING
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the polling loop timing                                    */
+/** @param[out] t copy of the timing                                           */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Timing starts over whenever the polling task is started.  The expected
+ *   period is the GyroInit period, or 1mS for the raw backend.
+ */
+void
+GyroTaskTimingGet( gyroTiming *t )
+{
+    memcpy( t, &theGyros.timing, sizeof(gyroTiming) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief    Clear the polling loop timing                                    */
+/*-----------------------------------------------------------------------------*/
+void
+GyroTaskTimingReset()
+{
+    GyroTimingReset( &theGyros.timing, theGyros.timing.expected );
+}
+#endif
+
+#ifdef  GYRO_TELEMETRY
+/*-----------------------------------------------------------------------------*/
+/** @brief    Send a batch of telemetry records                                */
+/** @returns  bytes sent                                                       */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Call from the user program every few GyroTask passes.  Each call sends
+ *   what the port has had time for since the last, GYRO_TELEMETRY_RATE
+ *   bytes a second, so the serial port is never asked for more than it can
+ *   send.  That is 720 records a second at 115200 baud, see gyroTelemetry.h.
+ *   The port must be set up for user control first.
+ */
+int
+GyroTelemetrySend()
+{
+    int     n;
+
+    n = GyroTelemetryDrain( &theGyros.telemetry, GyroTelemetryCredit( &theGyros.telemetry ) );
+    theGyros.telemetry.credit -= n;
+
+    return( n );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief    Get the number of telemetry records lost to a full ring          */
+/** @returns  records dropped since GyroInit                                   */
+/*-----------------------------------------------------------------------------*/
+long
+GyroTelemetryDroppedGet()
+{
+    return( theGyros.telemetry.dropped );
 }
+#endif
 
 /*-----------------------------------------------------------------------------*/
 /** @brief    ROBOTC gyro warning elination                                    */
@@ -259,10 +1779,44 @@ GyroWarningEliminate()
 {
     GyroDebug(0);
     GyroReinit();
+    GyroReinit( true );
+    GyroDriftModeSet( kGyroDriftThreshold );
+    GyroDriftParamsSet();
+    GyroRawJitterSet();
+    GyroAdd( in1 );
     GyroAngleDegGet();
     GyroAngleRadGet();
     GyroAngleAbsGet();
     GyroValidGet();
+    GyroRecalDoneGet();
+    GyroSnapshotGet( NULL );
+    GyroAngleAbsAt( 0, NULL );
+    GyroAngleDegAt( 0, NULL );
+    GyroRateAvg( 0, 0, NULL );
+#ifdef  GYRO_TIMING
+    GyroTaskTimingGet( NULL );
+    GyroTaskTimingReset();
+#endif
+#ifdef  GYRO_TELEMETRY
+    GyroTelemetrySend();
+    GyroTelemetryDroppedGet();
+#endif
+#ifdef  GYRO_ODOMETRY
+    GyroOdometryInit( dgtl1, dgtl3, 1.0 );
+    GyroPoseSet( 0, 0 );
+    GyroPoseGet( NULL );
+#endif
+#ifdef  GYRO_TURN
+    GyroTurnInit( port1, port10 );
+    GyroTurnParamsGet( NULL );
+    GyroTurnParamsSet( NULL );
+    GyroTurnTo( 0 );
+    GyroTurnBy( 0 );
+    GyroHeadingHold( 0 );
+    GyroTurnStop();
+    GyroTurnDoneGet();
+    GyroTurnWait();
+#endif
     GyroWarningEliminate();
 }
 
@@ -0,0 +1,211 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroOdometry.h                                               */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+// Stop recursive includes
+#ifndef __GYROODOMETRY__
+#define __GYROODOMETRY__
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroOdometry.h
+  * @brief   Gyro and encoder odometry moved on by the gyro polling task
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Define GYRO_ODOMETRY before including gyroLib2.c for GyroOdometryInit,
+ *   GyroPoseSet and GyroPoseGet.  Without it the polling task, the sample
+ *   and the gyro table carry nothing for odometry.
+ *
+ *   The pose is kept in encoder counts with GYRO_ODO_SHIFT fraction bits.
+ *   Headings are a 16 bit phase, 65536 per turn, looked up in a quarter wave
+ *   sine table of GYRO_SIN_SIZE steps scaled by 2^GYRO_SIN_SHIFT.
+ */
+
+#define GYRO_ODO_SHIFT          8
+#define GYRO_SIN_SIZE           256
+#define GYRO_SIN_SHIFT          14
+
+// Functions here may be compiled into more than one file on the host
+#ifndef GYRO_ODOMETRY_FUNC
+#define GYRO_ODOMETRY_FUNC
+#endif
+
+// Gyro angle to phase, the float build needs one float multiply for this
+#ifdef  GYRO_FIXED_POINT
+#define GyroAngleToPhase(a)     (((a) * 18641L) >> 14)
+#else
+#define GyroAngleToPhase(a)     ((long)((a) * (65536.0 / 360.0)))
+#endif
+
+// Structure to hold the odometry state, only the polling task changes it
+typedef struct _gyroOdometry {
+    bool        enabled;                        ///< GyroOdometryInit has been called
+    bool        primed;                         ///< encoders and heading read once
+    int         gyro;                           ///< gyro giving the heading
+    tSensors    port[2];                        ///< left and right quad encoders
+    long        count[2];                       ///< encoder counts at the last pass
+    long        phase;                          ///< heading at the last pass
+    long        x;                              ///< position, counts << GYRO_ODO_SHIFT
+    long        y;
+    float       scale;                          ///< distance per encoder count
+    bool        set_request;                    ///< GyroPoseSet waiting for the task
+    long        set_x;
+    long        set_y;
+    int         sin[GYRO_SIN_SIZE + 1];         ///< first quarter of sine
+    } gyroOdometry;
+
+/// Robot position from the gyro heading and two drive encoders
+typedef struct _gyroPose {
+    bool        valid;                          ///< indicates heading is valid
+    float       x;                              ///< position along heading 0
+    float       y;                              ///< position along heading 90 deg
+    float       theta;                          ///< heading in range 0 to 2pi radians
+    long        time;                           ///< nSysTime when sampled
+    long        sequence;                       ///< increments every sample
+    } gyroPose;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Start again at 0, 0 and fill the quarter wave sine table        */
+/** @param[in] o the odometry                                                  */
+/** @param[in] left quad encoder on the left side                              */
+/** @param[in] right quad encoder on the right side                            */
+/** @param[in] scale distance moved per encoder count                          */
+/** @param[in] gyro the gyro giving the heading                                */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_ODOMETRY_FUNC void
+GyroOdometryReset( gyroOdometry *o, tSensors left, tSensors right, float scale, int gyro )
+{
+    int     i;
+
+    // the only trig, done once
+    for(i=0;i<=GYRO_SIN_SIZE;i++)
+        o->sin[i] = sin( (PI / 2.0) * i / GYRO_SIN_SIZE ) * (1L << GYRO_SIN_SHIFT) + 0.5;
+
+    o->port[0]     = left;
+    o->port[1]     = right;
+    o->gyro        = gyro;
+    o->scale       = scale;
+    o->primed      = false;
+    o->x           = 0;
+    o->y           = 0;
+    o->set_request = false;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Sine from the quarter wave table                                */
+/** @param[in] o the odometry                                                  */
+/** @param[in] p phase, 65536 per turn                                         */
+/** @returns   sine << GYRO_SIN_SHIFT                                          */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_ODOMETRY_FUNC int
+GyroOdometrySin( gyroOdometry *o, long p )
+{
+    long    q = p & 0x3FFF;
+    long    v;
+    int     f;
+
+    // second and fourth quarters run back down the table
+    if( p & 0x4000 )
+        q = 0x4000 - q;
+
+    // 64 phase steps between table entries
+    f = q & 63;
+    q = q >> 6;
+    v = o->sin[q];
+    if( f != 0 )
+        v += ((o->sin[q+1] - v) * f) >> 6;
+
+    return( (p & 0x8000) ? -v : v );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Move the pose on by one pass, called only by the polling task  */
+/** @param[in] o the odometry                                                  */
+/** @param[in] valid the heading can be used                                   */
+/** @param[in] p heading as a phase, see GyroAngleToPhase                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The distance is the mean of the two encoder changes and it is taken to
+ *   be along the heading half way through the pass, which is the direction
+ *   of the chord if the robot followed an arc.  Using the arc length rather
+ *   than the chord is out by dtheta^2 / 24, under 0.1% at 360 deg/sec.
+ *   The update is integer only with no divide, the float build spends one
+ *   float multiply turning the heading into a phase.
+ */
+
+GYRO_ODOMETRY_FUNC void
+GyroOdometryMove( gyroOdometry *o, bool valid, long p )
+{
+    long    left, right;
+    long    ds2;
+    long    dp;
+
+    left  = SensorValue[ o->port[0] ];
+    right = SensorValue[ o->port[1] ];
+    p     = p & 0xFFFF;
+
+    if( o->set_request )
+        {
+        o->set_request = false;
+        o->x = o->set_x;
+        o->y = o->set_y;
+        }
+
+    if( valid && o->primed )
+        {
+        // twice the distance in counts
+        ds2 = (left - o->count[0]) + (right - o->count[1]);
+
+        // heading change, shortest way round, then the mid point
+        dp = ((p - o->phase + 0x8000) & 0xFFFF) - 0x8000;
+        dp = o->phase + (dp >> 1);
+
+        // ds2 * sin is counts << (GYRO_SIN_SHIFT + 1), round to GYRO_ODO_SHIFT
+        o->x += (ds2 * GyroOdometrySin( o, dp + 0x4000 ) + (1L << (GYRO_SIN_SHIFT - GYRO_ODO_SHIFT))) >> (GYRO_SIN_SHIFT + 1 - GYRO_ODO_SHIFT);
+        o->y += (ds2 * GyroOdometrySin( o, dp )          + (1L << (GYRO_SIN_SHIFT - GYRO_ODO_SHIFT))) >> (GYRO_SIN_SHIFT + 1 - GYRO_ODO_SHIFT);
+        }
+
+    // encoders move while the gyro calibrates, start from wherever they are
+    o->primed   = valid;
+    o->count[0] = left;
+    o->count[1] = right;
+    o->phase    = p;
+}
+
+#endif  // __GYROODOMETRY__
@@ -0,0 +1,109 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroProfile.h                                                */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+// Stop recursive includes
+#ifndef __GYROPROFILE__
+#define __GYROPROFILE__
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroProfile.h
+  * @brief   Compile time gyro profiles for gyroSim.c and gyroLib2.c
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Define GYRO_PROFILE before including gyroSim.c or gyroLib2.c to select
+ *   the gyro and how it is mounted, the default is the VEX yaw rate gyro
+ *   the right way up.  Everything here is a constant so the integration
+ *   loops are built for one profile, there is no runtime divide by the scale.
+ *
+ *   For GYRO_PROFILE_CUSTOM define all the GYRO_P_xxx values yourself.
+ */
+
+#define GYRO_PROFILE_VEX            1   ///< VEX yaw rate gyro, label up
+#define GYRO_PROFILE_VEX_INVERTED   2   ///< VEX yaw rate gyro, label down
+#define GYRO_PROFILE_VEX_QUIET      3   ///< VEX gyro on a well filtered port
+#define GYRO_PROFILE_CUSTOM         99  ///< GYRO_P_xxx supplied by the user
+
+#ifndef GYRO_PROFILE
+#define GYRO_PROFILE                GYRO_PROFILE_VEX
+#endif
+
+//   GYRO_P_SCALE            counts * mS per (deg * 10)
+//   GYRO_P_FULL_SCALE       gyro value wraps at +/- this, deg * 10
+//   GYRO_P_JITTER           changes from the bias this small are noise
+//   GYRO_P_SIGN             1, or -1 if the gyro is upside down
+//   GYRO_P_DRIFT_THRESHOLD  gyroLib2, changes this small are drift
+
+#if GYRO_PROFILE == GYRO_PROFILE_VEX
+#define GYRO_P_SCALE                130
+#define GYRO_P_FULL_SCALE           3600
+#define GYRO_P_JITTER               4
+#define GYRO_P_SIGN                 1
+#define GYRO_P_DRIFT_THRESHOLD      3
+#elif GYRO_PROFILE == GYRO_PROFILE_VEX_INVERTED
+#define GYRO_P_SCALE                130
+#define GYRO_P_FULL_SCALE           3600
+#define GYRO_P_JITTER               4
+#define GYRO_P_SIGN                 (-1)
+#define GYRO_P_DRIFT_THRESHOLD      3
+#elif GYRO_PROFILE == GYRO_PROFILE_VEX_QUIET
+#define GYRO_P_SCALE                130
+#define GYRO_P_FULL_SCALE           3600
+#define GYRO_P_JITTER               2
+#define GYRO_P_SIGN                 1
+#define GYRO_P_DRIFT_THRESHOLD      2
+#elif GYRO_PROFILE != GYRO_PROFILE_CUSTOM
+#error "unknown GYRO_PROFILE"
+#endif
+
+// Divide by the scale as a multiply and shift.  The reciprocal is rounded
+// up, floor(x / GYRO_P_SCALE) is exact for 0 <= x < GYRO_P_RECIP_RANGE as
+// long as GYRO_P_SCALE * GYRO_P_RECIP - 2^GYRO_P_SHIFT is under 128, and the
+// product fits in 31 bits for any scale over 64.  The host gyroKernel tool
+// checks every x for the profile it is built with.
+#define GYRO_P_SHIFT                22
+#define GYRO_P_RECIP                (((1L << GYRO_P_SHIFT) + GYRO_P_SCALE - 1) / GYRO_P_SCALE)
+#define GYRO_P_RECIP_RANGE          32768L
+
+// The reciprocal is over 2^16 for a scale of 64 or less and the product
+// with x near GYRO_P_RECIP_RANGE no longer fits in a long.
+#if GYRO_P_SCALE <= 64
+#error "GYRO_P_SCALE must be over 64 for the reciprocal divide"
+#endif
+
+#endif  // __GYROPROFILE__
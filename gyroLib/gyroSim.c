@@ -37,6 +37,12 @@
 /*                                                                             */
 /*-----------------------------------------------------------------------------*/
 // Simulation of the internal ROBOTC gyro calculations
+//
+// The integration is built for the profile selected in gyroProfile.h, define
+// GYRO_SIM_GENERIC to use the original loop that divides every sample.
+
+#include "gyroProfile.h"
+#include "gyroTiming.h"
 
 typedef  long      int32_t;
 typedef  short     int16_t;
@@ -44,12 +50,90 @@ typedef  short     int16_t;
 // final value in deg * 10
 static int32_t     GyroValue = 0;
 
-// filter out noise.
-const int GyroJitterRange = 4;
+// filter out noise, gyroJitterRangeSet can change it
+static int GyroJitterRange = GYRO_P_JITTER;
 
 // the gyro analog port
 static  tSensors   gyroAnalogPin = in1;
 
+// calibration modes
+#define kGyroCalFixed       0   ///< 200mS settle then 1024 samples, as ROBOTC
+#define kGyroCalAdaptive    1   ///< stop sampling once the bias has converged
+
+// adaptive calibration, sample until the standard error of the bias is
+// below 1/kGyroCalTolerance counts, but always take at least kGyroCalMin
+#define kGyroCalSettle      100
+#define kGyroCalMin         64
+#define kGyroCalTolerance   8
+
+// bias samples, fixed calibration takes this many and adaptive at most this
+// many, ROBOTC uses 1024
+#define kGyroCalSamples     1024
+#define kGyroCalSamplesMax  4096
+
+static  int        gyroCalSamples = kGyroCalSamples;
+
+// integration, see gyroIntegratorSet
+#define kGyroIntRect        0   ///< each sample stands for the whole tick, as ROBOTC
+#define kGyroIntTrapezoid   1   ///< mean of this sample and the last one
+#define kGyroIntSimpson     2   ///< Simpson's rule over pairs of equal ticks
+
+#define kGyroIntUnit        6144    ///< weighted integral is counts * mS * 1024 * 6
+#define kGyroIntChunk       16      ///< mS weighted at once so a late tick cannot overflow
+
+static  int        gyroIntMode   = kGyroIntRect;
+static  bool       gyroIntSoft   = false;   ///< soft noise gate in place of the dead band
+
+// remainder of the weighted integral, whole counts * mS go to the angle
+static  int32_t    GyroIntFine   = 0;
+
+// warm start, stationary samples used to refine a stored bias and the
+// weight, in samples, given to the stored bias
+#define kGyroRefineCycles   1024
+#define kGyroRefineWeight   256
+
+static  int        gyroCalMode   = kGyroCalAdaptive;
+
+// bias in counts * 1024 from the last calibration, save this and pass it to
+// initGyro for a warm start
+static  int32_t    GyroBiasFine  = 0;
+
+// GyroValue can be used
+static  bool       GyroValid     = false;
+
+#ifdef  GYRO_TIMING
+// loop timing, see gyroTiming.h
+static  gyroTiming GyroTiming;
+#endif
+
+/*-----------------------------------------------------------------------------*/
+/** @brief  Add weight * dt to the weighted integral                           */
+/** @param[in] weight six times the rate in counts * 1024                      */
+/** @param[in] dt mS                                                           */
+/** @returns   whole counts * mS ready to go to the angle                      */
+/*-----------------------------------------------------------------------------*/
+int32_t
+gyroIntAdd( int32_t weight, int32_t dt )
+{
+    int32_t     whole = 0;
+    int32_t     q;
+    int32_t     n;
+
+    while( dt > 0 )
+        {
+        n   = dt > kGyroIntChunk ? kGyroIntChunk : dt;
+        dt -= n;
+
+        // truncate, the remainder keeps its sign so nothing is lost
+        GyroIntFine += weight * n;
+        q            = GyroIntFine / kGyroIntUnit;
+        GyroIntFine -= q * kGyroIntUnit;
+        whole       += q;
+        }
+
+    return( whole );
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief task that calculates the gyro value in the same way as ROBOTC       */
 /*-----------------------------------------------------------------------------*/
@@ -61,48 +145,228 @@ task gyroSim()
     int32_t     GyroBias;
     int32_t     GyroSmallBias;
     int32_t     GyroRaw;
-    int32_t     GyroRawFiltered = 0;
     int32_t     GyroValueTmp;
+    int32_t     GyroChange;
 
     int16_t     GyroDelta;
-    int32_t     GyroSensorScale = 130;
-    int32_t     GyroFullScale   = 3600;
+#ifdef  GYRO_SIM_GENERIC
+    int32_t     GyroRawFiltered = 0;
+    int32_t     GyroSensorScale = GYRO_P_SCALE;
+    int32_t     GyroFullScale   = GYRO_P_FULL_SCALE;
+    int32_t     GyroSensorSign  = GYRO_P_SIGN;
+#else
+    int32_t     GyroRem   = 0;
+    int32_t     GyroQuot;
+    int32_t     GyroWrap  = 0;
+    int32_t     GyroTurns = 0;
+#endif
     int32_t     GyroJitterCycles = 0;
+    int32_t     GyroLastTime;
+    int32_t     GyroDt;
+    int32_t     GyroFirst;
+    bool        GyroRefine = false;
+    int32_t     GyroRefineAcc = 0;
+    int32_t     GyroRefineN = 0;
+    int32_t     GyroBiasStored = 0;
+    float       GyroDevAcc = 0;
+    float       GyroDevSq  = 0;
+    bool        GyroIntOn = (gyroIntMode != kGyroIntRect) || gyroIntSoft;
+    int32_t     GyroIntD;
+    int32_t     GyroIntAbs;
+    int32_t     GyroIntJ;
+    int32_t     GyroIntPrev = 0;
+    int32_t     GyroIntMid = 0;
+    int32_t     GyroIntMidDt = 0;
+    bool        GyroIntHalf = false;
 
-    // Delay for 200 milliseconds. This is to allow the gyro to stabilize when it is first powered up.
-    // The datasheet indicates that this may take 50 milliseconds so we'll run it a little longer.
-    wait1Msec(200);
+    GyroValid = false;
 
-    // calculate bias
-    for(i=0;i<1024;i++)
+    if( gyroCalMode == kGyroCalFixed )
         {
-        GyroBiasAcc = GyroBiasAcc + SensorValue[ gyroAnalogPin ];
-        wait1Msec(1);
+        // Delay for 200 milliseconds. This is to allow the gyro to stabilize when it is first powered up.
+        // The datasheet indicates that this may take 50 milliseconds so we'll run it a little longer.
+        wait1Msec(200);
+
+        // calculate bias
+        for(i=0;i<gyroCalSamples;i++)
+            {
+            GyroBiasAcc = GyroBiasAcc + SensorValue[ gyroAnalogPin ];
+            wait1Msec(1);
+            }
+
+        // counts * 1024, in two parts so the sum * 1024 cannot overflow
+        if( gyroCalSamples == 1024 )
+            GyroBiasFine = GyroBiasAcc;
+        else
+            GyroBiasFine = (GyroBiasAcc / gyroCalSamples) * 1024 +
+                           ((GyroBiasAcc % gyroCalSamples) * 1024) / gyroCalSamples;
+        }
+    else
+        {
+        wait1Msec(kGyroCalSettle);
+
+        if( GyroBiasFine != 0 )
+            {
+            // warm start, use the stored bias now and refine it as we go
+            GyroRefine     = true;
+            GyroBiasStored = GyroBiasFine;
+            }
+        else
+            {
+            // calculate bias from deviations about the first sample, the
+            // variance tells us when we have enough samples
+            GyroFirst = SensorValue[ gyroAnalogPin ];
+            wait1Msec(1);
+
+            for(i=1;i<gyroCalSamples;i++)
+                {
+                GyroDelta   = SensorValue[ gyroAnalogPin ] - GyroFirst;
+                GyroDevAcc += GyroDelta;
+                GyroDevSq  += (float)GyroDelta * GyroDelta;
+
+                // converged when variance / n < 1/tolerance^2
+                if( i >= kGyroCalMin &&
+                    ((i+1) * GyroDevSq - GyroDevAcc * GyroDevAcc) * (kGyroCalTolerance * kGyroCalTolerance) <=
+                    (float)(i+1) * (i+1) * (i+1) )
+                    {
+                    i++;
+                    break;
+                    }
+
+                wait1Msec(1);
+                }
+
+            GyroBiasFine = GyroFirst * 1024 + (int32_t)(GyroDevAcc * 1024.0 / i);
+            }
         }
 
-    GyroBias      = GyroBiasAcc / 1024;
-    GyroSmallBias = GyroBiasAcc - (GyroBias * 1024);
+    GyroBias      = GyroBiasFine / 1024;
+    GyroSmallBias = GyroBiasFine - (GyroBias * 1024);
     // Ok bias done
+    GyroValid     = true;
+
+    GyroLastTime  = nSysTime;
+    GyroIntFine   = 0;
+    GyroIntJ      = (int32_t)GyroJitterRange * 1024;
+
+#ifdef  GYRO_TIMING
+    GyroTimingReset( &GyroTiming, 1 );
+#endif
 
     // Run forever
     while(true)
         {
+        GyroTimingStart( &GyroTiming );
+
         // Get raw analog value
         GyroRaw   = SensorValue[ gyroAnalogPin ];
         // remove bias
         GyroDelta = GyroRaw - GyroBias;
 
+        // refine a stored bias from samples that look stationary, the
+        // integer bias is held until the end so the sum stays consistent
+        if( GyroRefine && GyroDelta >= -GyroJitterRange && GyroDelta <= GyroJitterRange )
+            {
+            GyroRefineAcc += GyroDelta;
+            GyroRefineN++;
+
+            if( (GyroRefineN % 128) == 0 )
+                {
+                // weighted mean of stored bias and the new samples
+                GyroBiasFine  = GyroBiasStored +
+                                (GyroRefineAcc * 1024 - GyroRefineN * (GyroBiasStored - GyroBias * 1024)) /
+                                (kGyroRefineWeight + GyroRefineN);
+                GyroSmallBias = GyroBiasFine - (GyroBias * 1024);
+                }
+
+            if( GyroRefineN >= kGyroRefineCycles )
+                {
+                GyroRefine    = false;
+                GyroBias      = GyroBiasFine / 1024;
+                GyroSmallBias = GyroBiasFine - (GyroBias * 1024);
+                }
+            }
+
+        // time since the last sample, more than 1mS if we were run late
+        GyroDt       = nSysTime - GyroLastTime;
+        GyroLastTime = GyroLastTime + GyroDt;
+
         // ignore small changes
+        GyroChange = 0;
+        if( GyroIntOn )
+            {
+            // rate in counts * 1024 with the whole bias removed, the fine
+            // bias is in every sample so there is no small bias to correct
+            GyroIntD   = ((int32_t)GyroRaw << 10) - GyroBiasFine;
+            GyroIntAbs = abs( GyroIntD );
+
+            if( !gyroIntSoft )
+                {
+                if( GyroIntAbs <= (int32_t)GyroJitterRange * 1024 )
+                    GyroIntD = 0;
+                }
+            else
+            if( GyroIntAbs <= GyroIntJ / 2 )
+                GyroIntD = 0;
+            else
+            if( GyroIntAbs < GyroIntJ * 3 / 2 )
+                {
+                // weight rises from nothing at half the jitter range to all
+                // of it at one and a half, small turns are kept in part, a
+                // zero range never gets here so there is no divide by zero
+                GyroIntD = GyroIntD * (GyroIntAbs - GyroIntJ / 2) / GyroIntJ;
+                }
+
+            if( gyroIntMode == kGyroIntTrapezoid )
+                {
+                GyroChange  = gyroIntAdd( 3 * (GyroIntPrev + GyroIntD), GyroDt );
+                GyroIntPrev = GyroIntD;
+                }
+            else
+            if( gyroIntMode == kGyroIntSimpson )
+                {
+                if( !GyroIntHalf )
+                    {
+                    // middle of a pair, integrated with the next sample
+                    GyroIntMid   = GyroIntD;
+                    GyroIntMidDt = GyroDt;
+                    GyroIntHalf  = true;
+                    }
+                else
+                    {
+                    if( GyroDt == GyroIntMidDt )
+                        GyroChange = gyroIntAdd( 2 * (GyroIntPrev + 4 * GyroIntMid + GyroIntD), GyroDt );
+                    else
+                        {
+                        // a late tick, the spacing is uneven so use trapezoids
+                        GyroChange  = gyroIntAdd( 3 * (GyroIntPrev + GyroIntMid), GyroIntMidDt );
+                        GyroChange += gyroIntAdd( 3 * (GyroIntMid + GyroIntD), GyroDt );
+                        }
+                    GyroIntPrev = GyroIntD;
+                    GyroIntHalf = false;
+                    }
+                }
+            else
+                GyroChange = gyroIntAdd( 6 * GyroIntD, GyroDt );
+            }
+        else
         if ((GyroDelta < -GyroJitterRange) || (GyroDelta > +GyroJitterRange))
             {
-            // integrate angle
-            GyroRawFiltered += GyroDelta;
+            // integrate angle, the sample stands for all the elapsed time
+            GyroChange = (int32_t)GyroDelta * GyroDt;
 
-            // compensate for error in bias
-            if ((++GyroJitterCycles % 1024) == 0)
-                GyroRawFiltered -= GyroSmallBias;
+            // compensate for error in bias, once every 1024mS integrated
+            GyroJitterCycles += GyroDt;
+            while( GyroJitterCycles >= 1024 )
+                {
+                GyroJitterCycles -= 1024;
+                GyroChange       -= GyroSmallBias;
+                }
             }
 
+#ifdef  GYRO_SIM_GENERIC
+        GyroRawFiltered += GyroSensorSign * GyroChange;
+
         // calculate angle in deg * 10
         GyroValueTmp = GyroRawFiltered / GyroSensorScale;
 
@@ -112,6 +376,61 @@ task gyroSim()
 
         // and store for the user
         GyroValue = GyroValueTmp;
+#else
+        // the integral is held as ((turns * full scale) + wrap) * scale + rem
+        // so a sample is a multiply and shift, and nothing at all when still
+        if( GyroChange != 0 )
+            {
+#if GYRO_P_SIGN < 0
+            GyroChange = -GyroChange;
+#endif
+            // floor of (rem + change) / scale
+            GyroRem += GyroChange;
+            if( GyroRem >= 0 && GyroRem < GYRO_P_RECIP_RANGE )
+                GyroQuot = (GyroRem * GYRO_P_RECIP) >> GYRO_P_SHIFT;
+            else
+            if( GyroRem < 0 && GyroRem > GYRO_P_SCALE - GYRO_P_RECIP_RANGE )
+                GyroQuot = -(((GYRO_P_SCALE - 1 - GyroRem) * GYRO_P_RECIP) >> GYRO_P_SHIFT);
+            else
+                {
+                // only a very late sample gets here
+                GyroQuot = GyroRem / GYRO_P_SCALE;
+                if( GyroQuot * GYRO_P_SCALE > GyroRem )
+                    GyroQuot--;
+                }
+            GyroRem  -= GyroQuot * GYRO_P_SCALE;
+            GyroWrap += GyroQuot;
+
+            while( GyroWrap >= GYRO_P_FULL_SCALE )
+                {
+                GyroWrap -= GYRO_P_FULL_SCALE;
+                GyroTurns++;
+                }
+            while( GyroWrap < 0 )
+                {
+                GyroWrap += GYRO_P_FULL_SCALE;
+                GyroTurns--;
+                }
+
+            // the value the generic loop gets by dividing, truncated toward
+            // zero and clipped with the sign of the integral
+            GyroValueTmp = GyroWrap;
+            if( GyroTurns < 0 )
+                {
+                if( GyroRem != 0 )
+                    GyroValueTmp++;
+                if( GyroValueTmp == 0 || GyroValueTmp == GYRO_P_FULL_SCALE )
+                    GyroValueTmp = 0;
+                else
+                    GyroValueTmp -= GYRO_P_FULL_SCALE;
+                }
+
+            // and store for the user
+            GyroValue = GyroValueTmp;
+            }
+#endif
+
+        GyroTimingEnd( &GyroTiming );
 
         // sleep
         wait1Msec(1);
@@ -121,20 +440,127 @@ task gyroSim()
 /*-----------------------------------------------------------------------------*/
 /** @brief Initialize the gyro                                                 */
 /** @param[in] port the analog input the gyro is connected to                  */
+/** @param[in] mode kGyroCalAdaptive or kGyroCalFixed                          */
+/** @param[in] bias a bias from gyroBiasGet for a warm start, 0 for none       */
 /*-----------------------------------------------------------------------------*/
+/** @details
+ *   A warm start only needs the settle time, the stored bias is refined in
+ *   the background while GyroValue is already usable.  Warm start only works
+ *   with kGyroCalAdaptive.
+ */
 void
-initGyro( tSensors port = in1 )
+initGyro( tSensors port = in1, int mode = kGyroCalAdaptive, int32_t bias = 0 )
 {
     gyroAnalogPin = port;
+    gyroCalMode   = mode;
+    GyroBiasFine  = bias;
     GyroValue     = 0;
+    GyroValid     = false;
 
     startTask( gyroSim );
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief  Set the noise dead band                                            */
+/** @param[in] range changes in counts no larger than this are ignored         */
+/*-----------------------------------------------------------------------------*/
+void
+gyroJitterRangeSet( int range = GYRO_P_JITTER )
+{
+    // more would overflow the soft gate
+    if( range < 0 )
+        range = 0;
+    if( range > 32 )
+        range = 32;
+
+    GyroJitterRange = range;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief  Set the number of bias samples                                     */
+/** @param[in] samples samples taken by the next initGyro                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Fixed calibration takes exactly this many, adaptive calibration stops
+ *   at this many if the bias has not converged sooner.
+ */
+void
+gyroCalSamplesSet( int samples = kGyroCalSamples )
+{
+    if( samples < kGyroCalMin )
+        samples = kGyroCalMin;
+    if( samples > kGyroCalSamplesMax )
+        samples = kGyroCalSamplesMax;
+
+    gyroCalSamples = samples;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief  Select the integration                                             */
+/** @param[in] mode kGyroIntRect, kGyroIntTrapezoid or kGyroIntSimpson         */
+/** @param[in] soft true for a soft noise gate in place of the dead band       */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The defaults are the ROBOTC calculation.  Anything else keeps the rate
+ *   to 1/1024 count and weights it by the rule chosen before integrating.  The soft gate drops changes under half the jitter
+ *   range, passes those over one and a half times it and scales the ones
+ *   between, so a slow turn is not thrown away entirely.  Simpson's rule
+ *   updates GyroValue every other tick.  Takes effect at the next initGyro,
+ *   the cost per tick is reported by gyroBench -c on the host.
+ */
+void
+gyroIntegratorSet( int mode = kGyroIntRect, bool soft = false )
+{
+    gyroIntMode = mode;
+    gyroIntSoft = soft;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief  Get the bias from the last calibration                             */
+/** @returns bias in counts * 1024                                             */
+/*-----------------------------------------------------------------------------*/
+int32_t
+gyroBiasGet()
+{
+    return( GyroBiasFine );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief  Get the gyro validity                                              */
+/** @returns true once calibration is done                                     */
+/*-----------------------------------------------------------------------------*/
+bool
+gyroValidGet()
+{
+    return( GyroValid );
+}
+
+#ifdef  GYRO_TIMING
+/*-----------------------------------------------------------------------------*/
+/** @brief      Get the loop timing                                            */
+/** @param[out] t copy of the timing                                           */
+/*-----------------------------------------------------------------------------*/
+void
+gyroSimTimingGet( gyroTiming *t )
+{
+    memcpy( t, &GyroTiming, sizeof(gyroTiming) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief  Clear the loop timing                                              */
+/*-----------------------------------------------------------------------------*/
+void
+gyroSimTimingReset()
+{
+    GyroTimingReset( &GyroTiming, 1 );
+}
+#endif
+
 // Test code
 task main()
 {
-    char  str[32];
+    char     str[32];
+    int32_t  shown = -1;
 
     bLCDBacklight = true;
 
@@ -142,9 +568,13 @@ task main()
 
     while(1)
         {
-        // display current value
-        sprintf(str,"Gyro %5.1f   ", GyroValue );
-        displayLCDString(1, 0, str);
+        // display current value, the LCD is slow so only when it changes
+        if( GyroValue != shown )
+            {
+            shown = GyroValue;
+            sprintf(str,"Gyro %5.1f   ", shown / 10.0 );
+            displayLCDString(1, 0, str);
+            }
 
         wait1Msec(20);
         }
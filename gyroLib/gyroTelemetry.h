@@ -0,0 +1,243 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroTelemetry.h                                              */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+// Stop recursive includes
+#ifndef __GYROTELEMETRY__
+#define __GYROTELEMETRY__
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroTelemetry.h
+  * @brief   Binary gyro telemetry records and the ring buffer that holds them
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Define GYRO_TELEMETRY before including gyroLib2.c and GyroTask writes a
+ *   16 byte record for every gyro on every pass.  Records wait in a ring
+ *   buffer until the user program sends them, a batch at a time, with
+ *   GyroTelemetrySend.  Nothing is formatted on the cortex, host/gyroTelemetry
+ *   turns the stream back into csv.
+ *
+ *   A record, little endian
+ *
+ *     0      kGyroTeleSync
+ *     1      gyro number in bits 0-2, kGyroTeleRaw, kGyroTeleValid
+ *     2      sequence, counts every record including any dropped
+ *     3      check, all 16 bytes add up to 0
+ *     4-5    nSysTime, low 16 bits
+ *     6-7    raw       firmware value deg * 10, or ADC counts
+ *     8-9    filtered  firmware value less drift deg * 10, or ADC less bias
+ *     10-11  drift     drift removed deg * 10, or bias in 1/8 counts
+ *     12-15  abs_angle deg * 100
+ *
+ *   The writer only moves head and the reader only moves tail so GyroTask
+ *   never waits for the sender.  When the ring is full records are dropped
+ *   and counted, the sequence shows where.
+ *
+ *   Each send is given the bytes the port could have sent since the last
+ *   one, GYRO_TELEMETRY_RATE a second, so the batch follows the period and
+ *   number of gyros without ever asking more of the port than it can do.
+ *   At 115200 baud that is 720 records a second, one gyro polled every
+ *   2 mS or ten at the default 20 mS, faster than that records are dropped
+ *   whatever the batch.  Sends must also come before the ring fills, every
+ *   GYRO_TELEMETRY_SIZE / 16 records.
+ */
+
+#ifndef GYRO_TELEMETRY_SIZE
+#define GYRO_TELEMETRY_SIZE     512     ///< ring size in bytes, a power of 2
+#endif
+
+#ifndef GYRO_TELEMETRY_RATE
+#define GYRO_TELEMETRY_RATE     11520   ///< bytes a second the port sends, 115200 baud
+#endif
+
+#ifndef GYRO_TELEMETRY_PUTC
+#define GYRO_TELEMETRY_PUTC(c)  sendChar( uartOne, c )
+#endif
+
+// Functions here may be compiled into more than one file on the host
+#ifndef GYRO_TELEMETRY_FUNC
+#define GYRO_TELEMETRY_FUNC
+#endif
+
+#define kGyroTeleRecordSize     16
+#define kGyroTeleSync           0xA5
+#define kGyroTeleGyroMask       0x07
+#define kGyroTeleRaw            0x08    ///< raw analog backend
+#define kGyroTeleValid          0x10    ///< angle was valid
+
+// Structure to hold the records waiting to be sent
+typedef struct _gyroTelemetry {
+    long            head;                       ///< bytes written
+    long            tail;                       ///< bytes sent
+    long            dropped;                    ///< records lost to a full ring
+    long            credit;                     ///< bytes the port can take now
+    long            fraction;                   ///< part byte credit * 1000
+    long            time;                       ///< nSysTime of the last send
+    unsigned char   sequence;                   ///< of the next record
+    unsigned char   buf[GYRO_TELEMETRY_SIZE];
+    } gyroTelemetry;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Empty the ring                                                  */
+/** @param[in] t the telemetry                                                 */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TELEMETRY_FUNC void
+GyroTelemetryReset( gyroTelemetry *t )
+{
+    t->head     = 0;
+    t->tail     = 0;
+    t->dropped  = 0;
+    t->credit   = 0;
+    t->fraction = 0;
+    t->time     = nSysTime;
+    t->sequence = 0;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Add one record, called only by the polling task                 */
+/** @param[in] t the telemetry                                                 */
+/** @param[in] flags gyro number and kGyroTeleXxx flags                        */
+/** @param[in] raw value read from the port                                    */
+/** @param[in] filtered raw value less drift or bias                           */
+/** @param[in] drift drift or bias                                             */
+/** @param[in] angle absolute angle in deg * 100                               */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TELEMETRY_FUNC void
+GyroTelemetryPut( gyroTelemetry *t, int flags, int raw, int filtered, int drift, long angle )
+{
+    unsigned char   r[kGyroTeleRecordSize];
+    unsigned char   sum = 0;
+    long            time = nSysTime;
+    int             k;
+    int             i;
+
+    if( t->head - t->tail > GYRO_TELEMETRY_SIZE - kGyroTeleRecordSize )
+        {
+        t->dropped++;
+        t->sequence++;
+        return;
+        }
+
+    r[0]  = kGyroTeleSync;
+    r[1]  = flags;
+    r[2]  = t->sequence++;
+    r[3]  = 0;
+    r[4]  = time;
+    r[5]  = time >> 8;
+    r[6]  = raw;
+    r[7]  = raw >> 8;
+    r[8]  = filtered;
+    r[9]  = filtered >> 8;
+    r[10] = drift;
+    r[11] = drift >> 8;
+    r[12] = angle;
+    r[13] = angle >> 8;
+    r[14] = angle >> 16;
+    r[15] = angle >> 24;
+
+    for(i=0;i<kGyroTeleRecordSize;i++)
+        sum += r[i];
+    r[3] = -sum;
+
+    // record first, then let the reader see it
+    k = t->head & (GYRO_TELEMETRY_SIZE - 1);
+    for(i=0;i<kGyroTeleRecordSize;i++)
+        t->buf[k+i] = r[i];
+
+    t->head += kGyroTeleRecordSize;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Bytes the port has had time for since the last call             */
+/** @param[in] t the telemetry                                                 */
+/** @returns   bytes that may be sent now                                      */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TELEMETRY_FUNC long
+GyroTelemetryCredit( gyroTelemetry *t )
+{
+    long    now = nSysTime;
+    long    elapsed = now - t->time;
+
+    t->time = now;
+    if( elapsed > 1000 )
+        elapsed = 1000;
+
+    // the part byte carries to the next call so the rate does not drift
+    t->fraction += elapsed * GYRO_TELEMETRY_RATE;
+    t->credit   += t->fraction / 1000;
+    t->fraction  = t->fraction % 1000;
+
+    // unused time is not saved beyond a full ring
+    if( t->credit > GYRO_TELEMETRY_SIZE )
+        t->credit = GYRO_TELEMETRY_SIZE;
+
+    return( t->credit );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Send waiting records with GYRO_TELEMETRY_PUTC                   */
+/** @param[in] t the telemetry                                                 */
+/** @param[in] max most bytes to send, whole records only                      */
+/** @returns   bytes sent                                                      */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TELEMETRY_FUNC int
+GyroTelemetryDrain( gyroTelemetry *t, int max )
+{
+    long    n = t->head - t->tail;
+    int     k;
+    int     i;
+
+    if( n > max )
+        n = max - max % kGyroTeleRecordSize;
+
+    k = t->tail & (GYRO_TELEMETRY_SIZE - 1);
+    for(i=0;i<n;i++)
+        {
+        GYRO_TELEMETRY_PUTC( t->buf[k] );
+        k = (k + 1) & (GYRO_TELEMETRY_SIZE - 1);
+        }
+
+    t->tail += n;
+    return( n );
+}
+
+#endif  // __GYROTELEMETRY__
@@ -0,0 +1,206 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroTiming.h                                                 */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+// Stop recursive includes
+#ifndef __GYROTIMING__
+#define __GYROTIMING__
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroTiming.h
+  * @brief   Optional loop timing for GyroTask and gyroSim
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Define GYRO_TIMING before including gyroSim.c or gyroLib2.c to record how
+ *   often the polling loops really run and how long each pass takes.
+ *   Without it GyroTimingStart and GyroTimingEnd are empty and the loops are
+ *   exactly as they were.
+ *
+ *   Periods are measured with nSysTime.  The busy time of each pass uses
+ *   GYRO_TIMING_CLOCK(), which is nSysTime unless a finer clock is supplied
+ *   together with GYRO_TIMING_TICKS_MS.  On the cortex almost every pass is
+ *   under 1mS, busy_max is the useful number there.
+ */
+
+#ifdef  GYRO_TIMING
+
+#ifndef GYRO_TIMING_CLOCK
+#define GYRO_TIMING_CLOCK()     nSysTime
+#define GYRO_TIMING_TICKS_MS    1
+#endif
+
+// Functions here may be compiled into more than one file on the host
+#ifndef GYRO_TIMING_FUNC
+#define GYRO_TIMING_FUNC
+#endif
+
+// Histogram of mS late, bucket n holds lateness from 2^(n-1) to 2^n - 1 so
+// 0, 1, 2-3, 4-7, 8-15, 16-31, 32-63 and 64 or more
+#define kGyroTimingBuckets      8
+
+// Structure to hold the timing for one polling loop
+typedef struct _gyroTiming {
+    long        expected;                       ///< period the loop asks for in mS
+    long        count;                          ///< periods measured
+    long        period_min;                     ///< shortest period in mS
+    long        period_max;                     ///< longest period in mS
+    long        period_sum;                     ///< for the mean period
+    long        overruns;                       ///< periods longer than expected
+    long        hist[kGyroTimingBuckets];       ///< periods by mS late
+    long        busy_max;                       ///< longest pass in clock ticks
+    long        busy_sum;                       ///< for the mean pass
+    long        passes;                         ///< passes timed
+    long        last;                           ///< nSysTime at the last pass
+    long        start;                          ///< clock at the start of this pass
+    } gyroTiming;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Clear the counters                                              */
+/** @param[in] t the timing                                                    */
+/** @param[in] expected the period the loop asks for in mS                     */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TIMING_FUNC void
+GyroTimingReset( gyroTiming *t, long expected )
+{
+    int     i;
+
+    t->expected   = expected;
+    t->count      = 0;
+    t->period_min = 0;
+    t->period_max = 0;
+    t->period_sum = 0;
+    t->overruns   = 0;
+    t->busy_max   = 0;
+    t->busy_sum   = 0;
+    t->passes     = 0;
+    t->last       = -1;
+
+    for(i=0;i<kGyroTimingBuckets;i++)
+        t->hist[i] = 0;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Call at the top of every pass of the loop                       */
+/** @param[in] t the timing                                                    */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TIMING_FUNC void
+GyroTimingStart( gyroTiming *t )
+{
+    long    period;
+    long    late;
+    int     b = 0;
+
+    t->start = GYRO_TIMING_CLOCK();
+
+    if( t->last >= 0 )
+        {
+        period = nSysTime - t->last;
+
+        if( t->count == 0 || period < t->period_min )
+            t->period_min = period;
+        if( period > t->period_max )
+            t->period_max = period;
+        t->period_sum += period;
+        t->count++;
+
+        late = period - t->expected;
+        if( late > 0 )
+            t->overruns++;
+
+        // bucket is the number of bits in late
+        while( late > 0 && b < kGyroTimingBuckets - 1 )
+            {
+            late = late >> 1;
+            b++;
+            }
+        t->hist[b]++;
+        }
+
+    t->last = nSysTime;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Call at the end of every pass, before the wait                  */
+/** @param[in] t the timing                                                    */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TIMING_FUNC void
+GyroTimingEnd( gyroTiming *t )
+{
+    long    busy = GYRO_TIMING_CLOCK() - t->start;
+
+    if( busy > t->busy_max )
+        t->busy_max = busy;
+    t->busy_sum += busy;
+    t->passes++;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Mean period                                                     */
+/** @param[in] t the timing                                                    */
+/** @returns   mean period in mS                                               */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TIMING_FUNC float
+GyroTimingPeriodMean( gyroTiming *t )
+{
+    return( t->count > 0 ? (float)t->period_sum / t->count : 0.0 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Mean time spent in each pass                                    */
+/** @param[in] t the timing                                                    */
+/** @returns   mean busy time in mS                                            */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TIMING_FUNC float
+GyroTimingBusyMean( gyroTiming *t )
+{
+    return( t->passes > 0 ? (float)t->busy_sum / t->passes / GYRO_TIMING_TICKS_MS : 0.0 );
+}
+
+#else
+
+#define GyroTimingStart(t)
+#define GyroTimingEnd(t)
+
+#endif  // GYRO_TIMING
+
+#endif  // __GYROTIMING__
@@ -0,0 +1,321 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroTurn.h                                                   */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+// Stop recursive includes
+#ifndef __GYROTURN__
+#define __GYROTURN__
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroTurn.h
+  * @brief   Profiled turn to angle and heading hold run by the polling task
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Define GYRO_TURN before including gyroLib2.c for GyroTurnInit, GyroTurnTo
+ *   and the rest.  Without it the polling task and the gyro table carry
+ *   nothing for the controller.
+ *
+ *   The controller is float, it runs once a pass on gyro 0 straight after
+ *   the pass is published.
+ */
+
+// Functions here may be compiled into more than one file on the host
+#ifndef GYRO_TURN_FUNC
+#define GYRO_TURN_FUNC
+#endif
+
+// Turn controller modes
+#define kGyroTurnOff            0
+#define kGyroTurnProfile        1       ///< following a turn profile
+#define kGyroTurnHold           2       ///< holding the target heading
+
+// Turn profile shapes
+#define kGyroProfileTrapezoid   0       ///< constant acceleration ramps
+#define kGyroProfileSCurve      1       ///< sine squared ramps, no step in acceleration
+
+/// Turn controller settings, defaults suit a VEX drivetrain turning at
+/// about 360 deg/sec at full power
+typedef struct _gyroTurnParams {
+    float       vmax;                           ///< profile peak rate, deg/sec
+    float       amax;                           ///< profile peak acceleration, deg/sec^2
+    int         shape;                          ///< kGyroProfileTrapezoid or kGyroProfileSCurve
+    float       kv;                             ///< power per deg/sec of profile rate
+    float       ka;                             ///< power per deg/sec^2 of profile acceleration
+    float       ks;                             ///< power to overcome friction
+    float       kp;                             ///< power per deg of heading error
+    float       kd;                             ///< power per deg/sec of rate error
+    float       tolerance;                      ///< done within this many deg
+    float       rate_tolerance;                 ///< and turning slower than this, deg/sec
+    int         settle;                         ///< for this many mS
+    } gyroTurnParams;
+
+// Structure to hold the controller state, requests come from the user
+// program and only the polling task acts on them
+typedef struct _gyroTurn {
+    int         mode;                           ///< kGyroTurnOff, Profile or Hold
+    bool        request;                        ///< GyroTurnTo waiting for the task
+    int         request_mode;
+    float       request_target;
+    tMotor      motor[2];                       ///< left and right drive motors
+    gyroTurnParams params;                      ///< controller settings
+    float       target;                         ///< heading wanted, abs deg
+    float       from;                           ///< heading at the start of the profile
+    float       sign;                           ///< direction of the turn
+    float       vp;                             ///< profile peak rate
+    float       ta;                             ///< profile ramp time, sec
+    float       tc;                             ///< profile time at peak rate, sec
+    long        start;                          ///< nSysTime at the start of the profile
+    long        settled;                        ///< nSysTime when last outside tolerance
+    bool        done;                           ///< reached the target and settled
+    int         power;                          ///< last output
+    } gyroTurn;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Drive both motors, positive turns left                          */
+/** @param[in] ctl the controller                                              */
+/** @param[in] power -127 to 127                                               */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TURN_FUNC void
+GyroTurnMotors( gyroTurn *ctl, int power )
+{
+    ctl->power = power;
+    motor[ ctl->motor[0] ] = -power;
+    motor[ ctl->motor[1] ] =  power;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Stop the motors and the controller                              */
+/** @param[in] ctl the controller                                              */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Only touches the motors if the controller was driving them, so it is
+ *   safe before GyroTurnInit.  A later request starts it again.
+ */
+
+GYRO_TURN_FUNC void
+GyroTurnHalt( gyroTurn *ctl )
+{
+    if( ctl->mode == kGyroTurnOff )
+        return;
+
+    ctl->mode = kGyroTurnOff;
+    ctl->done = false;
+    GyroTurnMotors( ctl, 0 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Work out the profile for a turn                                 */
+/** @param[in] ctl the controller                                              */
+/** @param[in] from heading now, abs deg                                       */
+/** @param[in] to heading wanted, abs deg                                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Ramp up at amax, run at vmax, ramp down, or ramp straight down again if
+ *   the turn is too short to reach vmax.  The s curve ramp has the same
+ *   peak acceleration so it takes pi/2 longer.  Only the times are kept,
+ *   GyroTurnStep works out where the profile is each pass.
+ */
+
+GYRO_TURN_FUNC void
+GyroTurnProfile( gyroTurn *ctl, float from, float to )
+{
+    float   d = to - from;
+    float   a = ctl->params.amax;
+    float   v = ctl->params.vmax;
+
+    ctl->from  = from;
+    ctl->sign  = (d < 0) ? -1.0 : 1.0;
+    ctl->start = nSysTime;
+    d = abs(d);
+
+    // mean acceleration over the ramp
+    if( ctl->params.shape == kGyroProfileSCurve )
+        a = a * (2.0 / PI);
+
+    if( d * a < v * v )
+        v = sqrt( d * a );
+
+    ctl->vp = v;
+    ctl->ta = (v > 0) ? v / a : 0;
+    ctl->tc = (v > 0) ? (d - v * ctl->ta) / v : 0;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Profile position, rate and acceleration on one ramp            */
+/** @param[in]  ctl the controller                                             */
+/** @param[in]  t time into the ramp, sec                                      */
+/*-----------------------------------------------------------------------------*/
+
+GYRO_TURN_FUNC void
+GyroTurnRamp( gyroTurn *ctl, float t, float *pos, float *vel, float *acc )
+{
+    float   vp = ctl->vp;
+    float   ta = ctl->ta;
+    float   p;
+    float   s, c;
+
+    if( ctl->params.shape == kGyroProfileSCurve )
+        {
+        // half a turn over the ramp
+        p = t / ta * PI;
+        s = sin( p );
+        c = cos( p );
+
+        *vel = vp * 0.5 * (1.0 - c);
+        *pos = vp * 0.5 * (t - ta / PI * s);
+        *acc = vp * PI / (2.0 * ta) * s;
+        }
+    else
+        {
+        *vel = vp * t / ta;
+        *pos = *vel * t * 0.5;
+        *acc = vp / ta;
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Run the controller once, called only by the polling task       */
+/** @param[in] ctl the controller                                              */
+/** @param[in] valid the heading can be used                                   */
+/** @param[in] angle absolute heading, deg                                     */
+/** @param[in] rate turn rate, deg/sec                                         */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Feed forward from the profile rate and acceleration, plus feedback
+ *   from the heading error and from the gyro rate against the profile
+ *   rate.  With no valid heading the motors are stopped and the
+ *   controller turns off, a request made meanwhile waits for the heading.
+ */
+
+GYRO_TURN_FUNC void
+GyroTurnStep( gyroTurn *ctl, bool valid, float angle, float rate )
+{
+    float       t, ta, tc;
+    float       pos = 0, vel = 0, acc = 0;
+    float       err;
+    float       power;
+
+    // nothing to steer by, never leave the motors running
+    if( !valid )
+        {
+        GyroTurnHalt( ctl );
+        return;
+        }
+
+    if( ctl->request )
+        {
+        ctl->request = false;
+        ctl->mode    = ctl->request_mode;
+        ctl->target  = ctl->request_target;
+        ctl->done    = false;
+        ctl->settled = nSysTime;
+        if( ctl->mode == kGyroTurnOff )
+            GyroTurnMotors( ctl, 0 );
+        if( ctl->mode == kGyroTurnProfile )
+            GyroTurnProfile( ctl, angle, ctl->target );
+        }
+
+    if( ctl->mode == kGyroTurnOff )
+        return;
+
+    if( ctl->mode == kGyroTurnProfile )
+        {
+        t  = (nSysTime - ctl->start) / 1000.0;
+        ta = ctl->ta;
+        tc = ctl->tc;
+
+        if( t < ta )
+            GyroTurnRamp( ctl, t, &pos, &vel, &acc );
+        else
+        if( t < ta + tc )
+            {
+            GyroTurnRamp( ctl, ta, &pos, &vel, &acc );
+            pos += vel * (t - ta);
+            acc  = 0;
+            }
+        else
+        if( t < ta + tc + ta )
+            {
+            // the up ramp backwards from the end
+            GyroTurnRamp( ctl, ta + tc + ta - t, &pos, &vel, &acc );
+            pos = abs( ctl->target - ctl->from ) - pos;
+            acc = -acc;
+            }
+        else
+            ctl->mode = kGyroTurnHold;
+
+        pos = ctl->from + ctl->sign * pos;
+        vel = vel * ctl->sign;
+        acc = acc * ctl->sign;
+        }
+
+    if( ctl->mode == kGyroTurnHold )
+        {
+        pos = ctl->target;
+        vel = 0;
+        acc = 0;
+        }
+
+    err   = pos - angle;
+    power = ctl->params.kv * vel + ctl->params.ka * acc +
+            ctl->params.kp * err + ctl->params.kd * (vel - rate);
+
+    // friction, in the direction the profile or the error wants
+    if( vel > 0 || (vel == 0 && err >  ctl->params.tolerance * 0.5) )
+        power += ctl->params.ks;
+    if( vel < 0 || (vel == 0 && err < -ctl->params.tolerance * 0.5) )
+        power -= ctl->params.ks;
+
+    if( power > 127 )
+        power = 127;
+    if( power < -127 )
+        power = -127;
+    GyroTurnMotors( ctl, power );
+
+    // done once on target and still for long enough
+    if( ctl->mode != kGyroTurnHold ||
+        abs( ctl->target - angle ) > ctl->params.tolerance ||
+        abs( rate ) > ctl->params.rate_tolerance )
+        ctl->settled = nSysTime;
+    else
+    if( nSysTime - ctl->settled >= ctl->params.settle )
+        ctl->done = true;
+}
+
+#endif  // __GYROTURN__
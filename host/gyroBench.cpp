@@ -0,0 +1,592 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroBench.cpp                                                */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include <unistd.h>
+
+#include "robotc.h"
+#include "gyroTrace.h"
+
+#include "../gyroLib/gyroLib2.c"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroBench.cpp
+  * @brief   Accuracy and cost benchmark for the gyro pipeline
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Replays a corpus of traces with known heading through gyroSim.c and
+ *   GyroTask and reports, for each trace
+ *
+ *     sim ns      host time per gyroSim sample
+ *     task ns     host time per GyroTask sample
+ *     task us/s   host time in GyroTask per second, depends on the period
+ *     sim blk     basic blocks run per gyroSim sample
+ *     task blk    basic blocks run per GyroTask sample
+ *     sim err     gyroSim heading error at the end of the trace
+ *     final err   GyroAngleAbsGet error at the end of the trace
+ *     peak err    largest GyroAngleAbsGet error once the robot may move
+ *     drift/min   final err scaled to one minute of running
+ *
+ *   Results are compared against a baseline file and the run fails if the
+ *   error grows by more than a fixed margin, so a change to either file
+ *   cannot quietly make things worse.  The block counts are the cost that
+ *   is checked, the library is built with -fsanitize-coverage=trace-pc
+ *   and the shim counts every block each task runs, see
+ *   RobotcTaskBlocksGet.  They are the same on every run of a build so the
+ *   run fails if a loop gets more than kBlockFactor slower.  The times are
+ *   host timings with the task switch overhead removed, tens of nS a
+ *   sample, close to the timer noise and including the block counting, so
+ *   they are only checked with -k and only mean anything between runs on
+ *   the same quiet machine.
+ *
+ *   The baselines are for the default period, drift mode and no jitter,
+ *   runs with -p, -e or -j are only checked against a baseline given with
+ *   -b.
+ *
+ *   gyroBenchFixed is the same benchmark built with GYRO_FIXED_POINT.
+ *
+ *   -c compares the gyroSim integrators instead, see gyroIntegratorSet.  The
+ *   traces have kBenchPerMs ADC conversions per mS so the heading follows
+ *   the chassis trace, whose vibration aliases when read once a mS.  Each
+ *   row is one integrator with the peak error of gyroSim's own value,
+ *   unwrapped and checked every tick, on each trace and its cost per
+ *   gyroSim tick, the blocks are the most on any trace.  GyroAngleAbsGet would hide the differences behind the
+ *   GyroTask drift filter.  Rows no other integrator beats on both mean
+ *   peak error and blocks per tick are marked with *.  There is no
+ *   baseline for these.
+ */
+
+// Regression margins
+#define kErrorMargin        0.5     ///< deg, for final and peak error
+#define kDriftMargin        0.25    ///< deg/min
+#define kCostFactor         2.0     ///< allowed slow down
+#define kCostSlack          10.0    ///< ns, ignore tiny absolute changes
+#define kCostRepeats        5       ///< costs are the best of this many runs
+#define kBlockFactor        1.05    ///< allowed growth in blocks per sample
+
+#define kMaxResults         32
+
+// -c, ADC conversions per mS in the traces
+#define kBenchPerMs         8
+
+// gyroSim.c integration modes, that file is only built into the shim
+#define kBenchIntRect       0
+#define kBenchIntTrapezoid  1
+#define kBenchIntSimpson    2
+
+// With -j a quarter of all waits overrun
+#define kJitterPercent      25
+
+// Each build of the library and each backend has its own baseline
+#ifdef  GYRO_FIXED_POINT
+#define kBaseline           "bench/baseline_fixed.txt"
+#define kBaselineRaw        "bench/baseline_raw_fixed.txt"
+#else
+#define kBaseline           "bench/baseline.txt"
+#define kBaselineRaw        "bench/baseline_raw.txt"
+#endif
+
+// Structure to hold the results for one trace
+typedef struct _benchResult {
+    char    name[64];
+    double  simNs;
+    double  taskNs;
+    double  taskLoad;
+    double  simBlocks;
+    double  taskBlocks;
+    double  simError;
+    double  finalError;
+    double  peakError;
+    double  drift;
+    double  simPeak;                ///< largest gyroSim error once the robot may move
+    } benchResult;
+
+static  int         period = GYRO_PERIOD_DEFAULT;
+static  int         jitter = 0;
+static  int         drift = kGyroDriftThreshold;
+static  int         backend = kGyroBackendFirmware;
+
+static  const char *corpus[] = { "stationary", "slowspin", "spin", "turns", "vibration", "biaswalk" };
+
+#define kCorpusSize (int)(sizeof(corpus) / sizeof(corpus[0]))
+
+// Structure to hold one integrator for -c
+typedef struct _benchIntegrator {
+    const char *name;
+    int         mode;
+    bool        soft;
+    } benchIntegrator;
+
+static  benchIntegrator integrators[] = {
+    { "robotc",         kBenchIntRect,      false },
+    { "rect soft",      kBenchIntRect,      true  },
+    { "trap",           kBenchIntTrapezoid, false },
+    { "trap soft",      kBenchIntTrapezoid, true  },
+    { "simpson",        kBenchIntSimpson,   false },
+    { "simpson soft",   kBenchIntSimpson,   true  },
+    };
+
+#define kNumbIntegrators (int)(sizeof(integrators) / sizeof(integrators[0]))
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     A task that does nothing, used to measure the switch overhead   */
+/*-----------------------------------------------------------------------------*/
+
+task NullTask()
+{
+    while(true)
+        wait1Msec(1);
+}
+
+static double
+BenchOverhead()
+{
+    long    runs;
+    double  seconds;
+    double  best = 1e9;
+    int     i;
+
+    for(i=0;i<kCostRepeats;i++)
+        {
+        RobotcReset();
+        RobotcTimingEnable( true );
+        startTask( NullTask );
+        RobotcRun( 100000 );
+        RobotcTaskStatsGet( NullTask, &runs, &seconds );
+        stopTask( NullTask );
+
+        if( seconds / runs < best )
+            best = seconds / runs;
+        }
+
+    RobotcTimingEnable( false );
+    return( best );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Difference between two headings wrapped into +/- 180            */
+/*-----------------------------------------------------------------------------*/
+
+static double
+BenchWrap( double delta )
+{
+    delta = fmod( delta, 360.0 );
+    if( delta > 180.0 )
+        delta -= 360.0;
+    if( delta < -180.0 )
+        delta += 360.0;
+
+    return( delta );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Run one trace through the pipeline                              */
+/*-----------------------------------------------------------------------------*/
+
+static void
+BenchTrace( gyroTrace *trace, double overhead, benchResult *r )
+{
+    long    length = GyroTraceLengthGet( trace );
+    long    runs;
+    long    blocks;
+    double  seconds;
+    double  error;
+    long    value;
+    long    last = 0;
+    long    sim = 0;
+    long    t;
+
+    RobotcReset();
+    RobotcTimingEnable( true );
+    RobotcJitterSet( 0, 0 );
+    RobotcSourceSet( in1, GyroTraceSource, trace );
+
+    GyroDriftModeSet( drift );
+    GyroInit( in1, period, backend );
+
+    snprintf( r->name, sizeof(r->name), "%s", trace->name );
+    r->peakError = 0;
+    r->simPeak   = 0;
+
+    for(t=0;t<length;t++)
+        {
+        RobotcRun( 1 );
+
+        if( nSysTime < kGyroTraceSettleMs )
+            continue;
+
+        // load the cpu once calibration is done
+        if( nSysTime == kGyroTraceSettleMs )
+            RobotcJitterSet( jitter, kJitterPercent );
+
+        error = fabs( GyroAngleAbsGet() - GyroTraceTruthGet( trace, nSysTime ) );
+        if( error > r->peakError )
+            r->peakError = error;
+
+        if( backend == kGyroBackendRaw )
+            continue;
+
+        // gyroSim wraps at full scale, follow it in deg * 10
+        value = SensorValue[ in1 ];
+        if( nSysTime > kGyroTraceSettleMs )
+            {
+            if( value - last > 1800 )
+                sim -= 3600;
+            if( value - last < -1800 )
+                sim += 3600;
+            }
+        last = value;
+
+        error = fabs( (sim + value) / 10.0 - GyroTraceTruthGet( trace, nSysTime ) );
+        if( error > r->simPeak )
+            r->simPeak = error;
+        }
+
+    r->finalError = GyroAngleAbsGet() - GyroTraceTruthGet( trace, nSysTime );
+    r->drift      = r->finalError / ((length - kGyroTraceSettleMs) / 60000.0);
+
+    if( backend == kGyroBackendRaw )
+        {
+        // one stage, there is no firmware value to compare
+        r->simError = BenchWrap( r->finalError );
+        r->simNs    = 0;
+        r->simBlocks = 0;
+        RobotcTaskStatsGet( GyroRawTask, &runs, &seconds );
+        RobotcTaskBlocksGet( GyroRawTask, &blocks );
+        }
+    else
+        {
+        r->simError = BenchWrap( SensorValue[ in1 ] / 10.0 - GyroTraceTruthGet( trace, nSysTime ) );
+        RobotcTaskStatsGet( RobotcGyroFirmwareTaskGet( in1 ), &runs, &seconds );
+        RobotcTaskBlocksGet( RobotcGyroFirmwareTaskGet( in1 ), &blocks );
+        r->simNs     = (seconds / runs - overhead) * 1e9;
+        r->simBlocks = (double)blocks / runs;
+        RobotcTaskStatsGet( GyroTask, &runs, &seconds );
+        RobotcTaskBlocksGet( GyroTask, &blocks );
+        }
+    r->taskNs = (seconds / runs - overhead) * 1e9;
+    r->taskBlocks = (double)blocks / runs;
+    r->taskLoad = r->taskNs * runs / length;
+
+    RobotcTimingEnable( false );
+    RobotcJitterSet( 0, 0 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Baseline file, one line per trace with the same columns         */
+/*-----------------------------------------------------------------------------*/
+
+static int
+BenchBaselineLoad( const char *filename, benchResult *base )
+{
+    FILE   *fp;
+    char    line[256];
+    int     n = 0;
+
+    if( (fp = fopen( filename, "r" )) == NULL )
+        return( 0 );
+
+    while( n < kMaxResults && fgets( line, sizeof(line), fp ) != NULL )
+        {
+        if( line[0] == '#' )
+            continue;
+        if( sscanf( line, "%63s %lf %lf %lf %lf %lf %lf %lf %lf %lf", base[n].name,
+                    &base[n].simNs, &base[n].taskNs, &base[n].taskLoad,
+                    &base[n].simBlocks, &base[n].taskBlocks, &base[n].simError,
+                    &base[n].finalError, &base[n].peakError, &base[n].drift ) == 10 )
+            n++;
+        }
+
+    fclose( fp );
+    return( n );
+}
+
+static void
+BenchPrint( FILE *fp, benchResult *r )
+{
+    fprintf( fp, "%-12s %8.1f %8.1f %9.2f %8.1f %8.1f %9.2f %9.2f %9.2f %9.2f\n", r->name,
+             r->simNs, r->taskNs, r->taskLoad, r->simBlocks, r->taskBlocks,
+             r->simError, r->finalError, r->peakError, r->drift );
+}
+
+static bool
+BenchCheck( benchResult *r, benchResult *base )
+{
+    bool    ok = true;
+
+    if( fabs( r->simError ) > fabs( base->simError ) + kErrorMargin )
+        {
+        printf( "  FAIL %s sim err %.2f, baseline %.2f\n", r->name, r->simError, base->simError );
+        ok = false;
+        }
+    if( fabs( r->finalError ) > fabs( base->finalError ) + kErrorMargin )
+        {
+        printf( "  FAIL %s final err %.2f, baseline %.2f\n", r->name, r->finalError, base->finalError );
+        ok = false;
+        }
+    if( r->peakError > base->peakError + kErrorMargin )
+        {
+        printf( "  FAIL %s peak err %.2f, baseline %.2f\n", r->name, r->peakError, base->peakError );
+        ok = false;
+        }
+    if( fabs( r->drift ) > fabs( base->drift ) + kDriftMargin )
+        {
+        printf( "  FAIL %s drift %.2f, baseline %.2f\n", r->name, r->drift, base->drift );
+        ok = false;
+        }
+    if( r->simBlocks > base->simBlocks * kBlockFactor )
+        {
+        printf( "  FAIL %s sim blocks %.1f, baseline %.1f\n", r->name, r->simBlocks, base->simBlocks );
+        ok = false;
+        }
+    if( r->taskBlocks > base->taskBlocks * kBlockFactor )
+        {
+        printf( "  FAIL %s task blocks %.1f, baseline %.1f\n", r->name, r->taskBlocks, base->taskBlocks );
+        ok = false;
+        }
+    if( r->simNs > base->simNs * kCostFactor + kCostSlack )
+        {
+        printf( "  FAIL %s sim cost %.1f ns, baseline %.1f ns\n", r->name, r->simNs, base->simNs );
+        ok = false;
+        }
+    if( r->taskNs > base->taskNs * kCostFactor + kCostSlack )
+        {
+        printf( "  FAIL %s task cost %.1f ns, baseline %.1f ns\n", r->name, r->taskNs, base->taskNs );
+        ok = false;
+        }
+
+    return( ok );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Run the corpus through each gyroSim integrator                  */
+/*-----------------------------------------------------------------------------*/
+
+static void
+BenchIntegrators( long duration, double overhead )
+{
+    gyroTrace   traces[ kCorpusSize + 1 ];
+    benchResult run;
+    double      ns[ kNumbIntegrators ];
+    double      blocks[ kNumbIntegrators ];
+    double      mean[ kNumbIntegrators ];
+    double      peak[ kNumbIntegrators ][ kCorpusSize + 1 ];
+    bool        front;
+    int         i, j, k;
+
+    for(j=0;j<kCorpusSize;j++)
+        GyroTraceSynthesize( &traces[j], corpus[j], duration, 1, kBenchPerMs );
+    GyroTraceSynthesize( &traces[j], "chassis", duration, 1, kBenchPerMs );
+
+    for(i=0;i<kNumbIntegrators;i++)
+        {
+        RobotcGyroFirmwareIntegratorSet( in1, integrators[i].mode, integrators[i].soft );
+
+        ns[i]     = 1e9;
+        blocks[i] = 0;
+        mean[i]   = 0;
+        for(j=0;j<=kCorpusSize;j++)
+            {
+            for(k=0;k<kCostRepeats;k++)
+                {
+                BenchTrace( &traces[j], overhead, &run );
+                ns[i] = fmin( ns[i], run.simNs );
+                }
+            blocks[i]  = fmax( blocks[i], run.simBlocks );
+            peak[i][j] = run.simPeak;
+            mean[i]   += run.simPeak / (kCorpusSize + 1);
+            }
+        }
+    RobotcGyroFirmwareIntegratorSet( in1, kBenchIntRect, false );
+
+    printf( "%-15s %8s %8s", "integrator", "sim ns", "sim blk" );
+    for(j=0;j<=kCorpusSize;j++)
+        printf( " %10s", j < kCorpusSize ? corpus[j] : "chassis" );
+    printf( " %9s\n", "mean peak" );
+
+    for(i=0;i<kNumbIntegrators;i++)
+        {
+        front = true;
+        for(k=0;k<kNumbIntegrators;k++)
+            if( k != i && blocks[k] <= blocks[i] && mean[k] <= mean[i] && (blocks[k] < blocks[i] || mean[k] < mean[i]) )
+                front = false;
+
+        printf( "%-15s %8.1f %8.1f", integrators[i].name, ns[i], blocks[i] );
+        for(j=0;j<=kCorpusSize;j++)
+            printf( " %10.2f", peak[i][j] );
+        printf( " %9.2f %s\n", mean[i], front ? "*" : "" );
+        }
+}
+
+static void
+Usage()
+{
+    fprintf( stderr, "usage: gyroBench [-b baseline] [-u] [-k] [-c] [-d ms] [-p ms] [-j ms] [-e] [-a] [trace files...]\n" );
+    fprintf( stderr, "  -b baseline  compare against, default %s or %s\n", kBaseline, kBaselineRaw );
+    fprintf( stderr, "  -u           write the results as the new baseline\n" );
+    fprintf( stderr, "  -k           also fail on times over %.0fx the baseline\n", kCostFactor );
+    fprintf( stderr, "  -c           compare the gyroSim integrators, peak error per trace\n" );
+    fprintf( stderr, "  -d ms        synthetic trace length, default 120000\n" );
+    fprintf( stderr, "  -p ms        GyroTask polling period, default %d\n", GYRO_PERIOD_DEFAULT );
+    fprintf( stderr, "  -j ms        after calibration make %d%% of task waits overrun by up to ms\n", kJitterPercent );
+    exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+    const char *baseline = NULL;
+    bool        update = false;
+    bool        costs = false;
+    bool        compare = false;
+    long        duration = 120000;
+    benchResult results[ kMaxResults ];
+    benchResult base[ kMaxResults ];
+    benchResult run;
+    int         nResults = 0;
+    int         nBase;
+    gyroTrace   trace;
+    double      overhead;
+    bool        ok = true;
+    FILE       *fp;
+    int         c, i, j;
+
+    while( (c = getopt( argc, argv, "b:ukcd:p:j:ea" )) != -1 )
+        {
+        switch( c )
+            {
+            case 'b': baseline = optarg;         break;
+            case 'u': update   = true;           break;
+            case 'k': costs    = true;           break;
+            case 'c': compare  = true;           break;
+            case 'd': duration = atol( optarg ); break;
+            case 'p': period   = atoi( optarg ); break;
+            case 'j': jitter   = atoi( optarg ); break;
+            case 'e': drift    = kGyroDriftEstimator; break;
+            case 'a': backend  = kGyroBackendRaw; break;
+            default:  Usage();
+            }
+        }
+
+    // the baselines are for the default settings only
+    if( baseline == NULL && period == GYRO_PERIOD_DEFAULT && jitter == 0 && drift == kGyroDriftThreshold )
+        baseline = (backend == kGyroBackendRaw) ? kBaselineRaw : kBaseline;
+
+    overhead = BenchOverhead();
+
+    if( compare )
+        {
+        if( backend == kGyroBackendRaw )
+            Usage();
+        BenchIntegrators( duration, overhead );
+        return( 0 );
+        }
+
+    printf( "%-12s %8s %8s %9s %8s %8s %9s %9s %9s %9s\n", "trace", "sim ns", "task ns",
+            "task us/s", "sim blk", "task blk", "sim err", "final err", "peak err", "drift/min" );
+
+    for(i=0;i<kCorpusSize + (argc - optind) && nResults < kMaxResults;i++)
+        {
+        if( i < kCorpusSize )
+            GyroTraceSynthesize( &trace, corpus[i], duration );
+        else
+        if( !GyroTraceLoad( &trace, argv[ optind + i - kCorpusSize ] ) ||
+            !GyroTraceHasTruth( &trace ) )
+            {
+            fprintf( stderr, "gyroBench: %s has no heading, skipped\n", argv[ optind + i - kCorpusSize ] );
+            continue;
+            }
+
+        // accuracy is repeatable, costs are the best of several runs
+        for(j=0;j<kCostRepeats;j++)
+            {
+            BenchTrace( &trace, overhead, &run );
+            if( j > 0 )
+                {
+                run.simNs  = fmin( run.simNs,  results[ nResults ].simNs );
+                run.taskNs = fmin( run.taskNs, results[ nResults ].taskNs );
+                }
+            results[ nResults ] = run;
+            }
+        BenchPrint( stdout, &results[ nResults ] );
+        nResults++;
+        }
+
+    if( baseline == NULL )
+        {
+        printf( "no baseline for -p, -e or -j, give one with -b, nothing checked\n" );
+        return( update ? 1 : 0 );
+        }
+
+    if( update )
+        {
+        if( (fp = fopen( baseline, "w" )) == NULL )
+            {
+            fprintf( stderr, "gyroBench: cannot write %s\n", baseline );
+            return( 1 );
+            }
+        fprintf( fp, "# trace sim_ns task_ns task_us_per_s sim_blocks task_blocks sim_err final_err peak_err drift_per_min\n" );
+        for(i=0;i<nResults;i++)
+            BenchPrint( fp, &results[i] );
+        fclose( fp );
+        printf( "baseline written to %s\n", baseline );
+        return( 0 );
+        }
+
+    nBase = BenchBaselineLoad( baseline, base );
+    if( nBase == 0 )
+        {
+        printf( "no baseline in %s, nothing checked\n", baseline );
+        return( 0 );
+        }
+
+    for(i=0;i<nResults;i++)
+        {
+        for(j=0;j<nBase;j++)
+            {
+            if( strcmp( results[i].name, base[j].name ) != 0 )
+                continue;
+            if( !costs )
+                base[j].simNs = base[j].taskNs = 1e9;
+            ok = BenchCheck( &results[i], &base[j] ) && ok;
+            }
+        }
+
+    printf( "%s\n", ok ? "PASS" : "FAIL" );
+    return( ok ? 0 : 1 );
+}
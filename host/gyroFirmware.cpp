@@ -0,0 +1,153 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroFirmware.cpp                                             */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include "robotc.h"
+// shared by all the instances, it must not end up inside one namespace
+#include "../gyroLib/gyroTiming.h"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroFirmware.cpp
+  * @brief   The ROBOTC firmware gyro, as seen through SensorValue[]
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Setting SensorType[port] to sensorGyro starts the firmware integration on
+ *   that port.  On the host the firmware is gyroSim.c, which reproduces the
+ *   ROBOTC calculation, so one instance is compiled for each analog port.
+ */
+
+#define GYRO_FIRMWARE_NS    gyroFw1
+#include "gyroFirmwareInst.h"
+#undef  GYRO_FIRMWARE_NS
+#define GYRO_FIRMWARE_NS    gyroFw2
+#include "gyroFirmwareInst.h"
+#undef  GYRO_FIRMWARE_NS
+#define GYRO_FIRMWARE_NS    gyroFw3
+#include "gyroFirmwareInst.h"
+#undef  GYRO_FIRMWARE_NS
+#define GYRO_FIRMWARE_NS    gyroFw4
+#include "gyroFirmwareInst.h"
+#undef  GYRO_FIRMWARE_NS
+#define GYRO_FIRMWARE_NS    gyroFw5
+#include "gyroFirmwareInst.h"
+#undef  GYRO_FIRMWARE_NS
+#define GYRO_FIRMWARE_NS    gyroFw6
+#include "gyroFirmwareInst.h"
+#undef  GYRO_FIRMWARE_NS
+#define GYRO_FIRMWARE_NS    gyroFw7
+#include "gyroFirmwareInst.h"
+#undef  GYRO_FIRMWARE_NS
+#define GYRO_FIRMWARE_NS    gyroFw8
+#include "gyroFirmwareInst.h"
+#undef  GYRO_FIRMWARE_NS
+
+// Structure to hold the entry points for one firmware instance
+typedef struct _gyroFirmware {
+    void    (*start)( tSensors port );
+    void    (*stop)( void );
+    int     (*value)( void );
+    void    (*params)( int jitter, int calSamples );
+    void    (*integrator)( int mode, bool soft );
+    tRobotcTask (*taskGet)( void );
+    } gyroFirmware;
+
+static  gyroFirmware    firmware[ kNumbAnalogSensors ] = {
+    { gyroFw1::Start, gyroFw1::Stop, gyroFw1::Value, gyroFw1::Params, gyroFw1::Integrator, gyroFw1::TaskGet },
+    { gyroFw2::Start, gyroFw2::Stop, gyroFw2::Value, gyroFw2::Params, gyroFw2::Integrator, gyroFw2::TaskGet },
+    { gyroFw3::Start, gyroFw3::Stop, gyroFw3::Value, gyroFw3::Params, gyroFw3::Integrator, gyroFw3::TaskGet },
+    { gyroFw4::Start, gyroFw4::Stop, gyroFw4::Value, gyroFw4::Params, gyroFw4::Integrator, gyroFw4::TaskGet },
+    { gyroFw5::Start, gyroFw5::Stop, gyroFw5::Value, gyroFw5::Params, gyroFw5::Integrator, gyroFw5::TaskGet },
+    { gyroFw6::Start, gyroFw6::Stop, gyroFw6::Value, gyroFw6::Params, gyroFw6::Integrator, gyroFw6::TaskGet },
+    { gyroFw7::Start, gyroFw7::Stop, gyroFw7::Value, gyroFw7::Params, gyroFw7::Integrator, gyroFw7::TaskGet },
+    { gyroFw8::Start, gyroFw8::Stop, gyroFw8::Value, gyroFw8::Params, gyroFw8::Integrator, gyroFw8::TaskGet }
+    };
+
+void
+RobotcGyroFirmwareStart( tSensors port )
+{
+    firmware[port].start( port );
+}
+
+void
+RobotcGyroFirmwareStop( tSensors port )
+{
+    firmware[port].stop();
+}
+
+int
+RobotcGyroFirmwareValue( tSensors port )
+{
+    return( firmware[port].value() );
+}
+
+void
+RobotcGyroFirmwareParamsSet( tSensors port, int jitter, int calSamples )
+{
+    firmware[port].params( jitter, calSamples );
+}
+
+void
+RobotcGyroFirmwareIntegratorSet( tSensors port, int mode, bool soft )
+{
+    firmware[port].integrator( mode, soft );
+}
+
+tRobotcTask
+RobotcGyroFirmwareTaskGet( tSensors port )
+{
+    return( firmware[port].taskGet() );
+}
+
+#ifdef  GYRO_TIMING
+static  void    (*firmwareTiming[ kNumbAnalogSensors ])( gyroTiming *t ) = {
+    gyroFw1::gyroSimTimingGet, gyroFw2::gyroSimTimingGet,
+    gyroFw3::gyroSimTimingGet, gyroFw4::gyroSimTimingGet,
+    gyroFw5::gyroSimTimingGet, gyroFw6::gyroSimTimingGet,
+    gyroFw7::gyroSimTimingGet, gyroFw8::gyroSimTimingGet
+    };
+
+bool
+RobotcGyroFirmwareTimingGet( tSensors port, gyroTiming *timing )
+{
+    if( port < 0 || port >= kNumbAnalogSensors )
+        return( false );
+
+    firmwareTiming[port]( timing );
+    return( true );
+}
+#endif
@@ -0,0 +1,99 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroFirmwareInst.h                                           */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroFirmwareInst.h
+  * @brief   One instance of the firmware gyro model, see gyroFirmware.cpp
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Included once per analog port with GYRO_FIRMWARE_NS set to a unique
+ *   namespace, gyroSim.c keeps its state in file statics so each port needs
+ *   its own copy.  There is deliberately no include guard.
+ */
+
+namespace GYRO_FIRMWARE_NS {
+
+// gyroSim.c is the raw ADC consumer, it must not see the integrated value
+#define SensorValue     RobotcAnalogValue
+// the test main in gyroSim.c is not used on the host
+#define main            gyroSimMain
+
+#include "../gyroLib/gyroSim.c"
+
+#undef  SensorValue
+#undef  main
+
+static void
+Start( tSensors port )
+{
+    initGyro( port, kGyroCalFixed );
+}
+
+static void
+Stop()
+{
+    stopTask( gyroSim );
+}
+
+static void
+Params( int jitter, int calSamples )
+{
+    gyroJitterRangeSet( jitter );
+    gyroCalSamplesSet( calSamples );
+}
+
+static void
+Integrator( int mode, bool soft )
+{
+    gyroIntegratorSet( mode, soft );
+}
+
+static tRobotcTask
+TaskGet()
+{
+    return( gyroSim );
+}
+
+static int
+Value()
+{
+    return( GyroValue );
+}
+
+}
@@ -0,0 +1,244 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroKernel.cpp                                               */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include <unistd.h>
+#include <vector>
+
+#include "robotc.h"
+#include "gyroTrace.h"
+
+// Two copies of gyroSim.c, the original loop and the one built for the
+// profile, each with its own statics.  The test main is not used.
+#define main            gyroSimMain
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat"
+
+namespace generic {
+#define GYRO_SIM_GENERIC
+#include "../gyroLib/gyroSim.c"
+#undef  GYRO_SIM_GENERIC
+}
+
+namespace profiled {
+#include "../gyroLib/gyroSim.c"
+}
+
+#pragma GCC diagnostic pop
+
+#undef  main
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroKernel.cpp
+  * @brief   Compare the profile built gyroSim loop with the generic one
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Checks that the multiply and shift is an exact divide over its whole
+ *   range, then runs each synthetic trace through both loops, once without
+ *   and twice with late tasks, and fails if GyroValue ever differs.  The
+ *   second late run is late enough to take the slow path.  Reports host
+ *   time per sample for each loop from the run without late tasks, this
+ *   includes the task switch so only the difference between them means
+ *   much.  A host divide is only a few cycles so the saving is small here,
+ *   on the robot every ROBOTC operation skipped counts for more.
+ *
+ *   Build with -DGYRO_PROFILE=... to check another profile.
+ */
+
+#define kRepeats            9       ///< costs are the best of this many runs
+#define kLatePercent        25      ///< late runs, this many waits overrun
+
+static  const char *corpus[] = { "stationary", "slowspin", "spin", "turns", "vibration" };
+
+#define kCorpusSize (int)(sizeof(corpus) / sizeof(corpus[0]))
+
+// late runs, the maximum overrun in mS
+static  const int   lateMs[] = { 8, 400 };
+
+#define kLateSize   (int)(sizeof(lateMs) / sizeof(lateMs[0]))
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Check the reciprocal against a real divide                      */
+/*-----------------------------------------------------------------------------*/
+
+static long
+KernelRecipCheck()
+{
+    long    bad = 0;
+    long    x;
+
+    for(x=0;x<GYRO_P_RECIP_RANGE;x++)
+        if( ((x * GYRO_P_RECIP) >> GYRO_P_SHIFT) != x / GYRO_P_SCALE )
+            bad++;
+
+    // negative values as the loop does them, floor rather than truncate
+    for(x=GYRO_P_SCALE - GYRO_P_RECIP_RANGE + 1;x<0;x++)
+        if( -(((GYRO_P_SCALE - 1 - x) * GYRO_P_RECIP) >> GYRO_P_SHIFT) != (long)floor( (double)x / GYRO_P_SCALE ) )
+            bad++;
+
+    return( bad );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Run one trace through one of the loops                          */
+/** @param[in] trace the trace                                                 */
+/** @param[in] profile true for the profile loop, false for the generic one   */
+/** @param[in] late maximum overrun in mS, 0 for none                          */
+/** @param[out] values GyroValue every mS                                      */
+/** @returns   host seconds per sample                                         */
+/*-----------------------------------------------------------------------------*/
+
+static double
+KernelRun( gyroTrace *trace, bool profile, int late, std::vector<int> &values )
+{
+    long        length = GyroTraceLengthGet( trace );
+    tRobotcTask fn = profile ? profiled::gyroSim : generic::gyroSim;
+    long        runs;
+    double      seconds;
+    long        t;
+
+    RobotcReset();
+    RobotcTimingEnable( late == 0 );
+    RobotcJitterSet( late, late ? kLatePercent : 0 );
+    RobotcSourceSet( in1, GyroTraceSource, trace );
+
+    if( profile )
+        profiled::initGyro( in1, kGyroCalFixed );
+    else
+        generic::initGyro( in1, kGyroCalFixed );
+
+    values.resize( length );
+    for(t=0;t<length;t++)
+        {
+        RobotcRun( 1 );
+        values[t] = profile ? profiled::GyroValue : generic::GyroValue;
+        }
+
+    RobotcTaskStatsGet( fn, &runs, &seconds );
+    stopTask( fn );
+    RobotcTimingEnable( false );
+    RobotcJitterSet( 0, 0 );
+
+    return( runs > 0 ? seconds / runs : 0 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Samples where the two loops disagree                            */
+/*-----------------------------------------------------------------------------*/
+
+static long
+KernelCompare( const std::vector<int> &a, const std::vector<int> &b )
+{
+    long    bad = 0;
+    size_t  i;
+
+    for(i=0;i<a.size() && i<b.size();i++)
+        if( a[i] != b[i] )
+            bad++;
+
+    return( bad );
+}
+
+static void
+Usage()
+{
+    fprintf( stderr, "usage: gyroKernel [-d ms]\n" );
+    fprintf( stderr, "  -d ms        synthetic trace length, default 60000\n" );
+    exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+    long        duration = 60000;
+    gyroTrace   trace;
+    std::vector<int> a, b;
+    double      genericNs, profileNs;
+    long        bad, total = 0;
+    bool        ok = true;
+    int         c, i, j;
+
+    while( (c = getopt( argc, argv, "d:" )) != -1 )
+        {
+        switch( c )
+            {
+            case 'd': duration = atol( optarg ); break;
+            default:  Usage();
+            }
+        }
+
+    bad = KernelRecipCheck();
+    printf( "profile %d, scale %d, reciprocal %ld >> %d, %ld wrong\n", GYRO_PROFILE,
+            GYRO_P_SCALE, (long)GYRO_P_RECIP, GYRO_P_SHIFT, bad );
+    if( bad != 0 )
+        ok = false;
+
+    printf( "%-12s %10s %10s %10s %10s\n", "trace", "generic ns", "profile ns", "saving ns", "mismatch" );
+
+    for(i=0;i<kCorpusSize;i++)
+        {
+        GyroTraceSynthesize( &trace, corpus[i], duration );
+
+        genericNs = profileNs = 1e9;
+        for(j=0;j<kRepeats;j++)
+            {
+            genericNs = fmin( genericNs, KernelRun( &trace, false, 0, a ) * 1e9 );
+            profileNs = fmin( profileNs, KernelRun( &trace, true,  0, b ) * 1e9 );
+            }
+        bad = KernelCompare( a, b );
+
+        // late tasks change dt and exercise the slow path
+        for(j=0;j<kLateSize;j++)
+            {
+            KernelRun( &trace, false, lateMs[j], a );
+            KernelRun( &trace, true,  lateMs[j], b );
+            bad += KernelCompare( a, b );
+            }
+
+        printf( "%-12s %10.1f %10.1f %10.1f %10ld\n", corpus[i], genericNs, profileNs,
+                genericNs - profileNs, bad );
+        total += bad;
+        }
+
+    if( total != 0 )
+        ok = false;
+
+    printf( "%s\n", ok ? "PASS" : "FAIL" );
+    return( ok ? 0 : 1 );
+}
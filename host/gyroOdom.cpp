@@ -0,0 +1,408 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroOdom.cpp                                                 */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "robotc.h"
+#include "gyroTrace.h"
+
+#include "../gyroLib/gyroLib2.c"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroOdom.cpp
+  * @brief   Check the gyro and encoder odometry against synthetic paths
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Each path is a forward speed and a turn rate every mS.  From them come
+ *   the true position, a gyro trace and the counts of two quad encoders.
+ *   The library pose is compared with the truth, and so is the usual user
+ *   code that reads GyroAngleRadGet and the encoders every 20mS and does
+ *   the trig itself.  Fails if the library is further out than that.
+ *
+ *   Cost is host time per update for GyroOdometryUpdate and for the same
+ *   update in float with sin and cos.  The host has an FPU, the cortex does
+ *   not and there the float version is many times slower.
+ */
+
+#define kTrack              14.0        ///< inches between the wheels
+#define kInchPerCount       (4.0 * PI / 360.0)  ///< 4 inch wheel, 360 count encoder
+#define kUserPeriod         20          ///< user loop and check period in mS
+#define kCostLoops          1000000
+#define kRepeats            9
+#define kSlackInch          0.25        ///< library may be this much worse
+
+// Path, forward speed in inch/sec and turn rate in deg/sec at a time
+typedef void    (*tOdomPath)( long t, double *speed, double *rate );
+
+// Structure to hold a named path
+typedef struct _odomPath {
+    const char *name;
+    const char *description;
+    tOdomPath   path;
+    } odomPath;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Trapezoid, 0 to peak over ramp mS, hold, back to 0 at length    */
+/*-----------------------------------------------------------------------------*/
+
+static double
+Trapezoid( long t, long length, long ramp, double peak )
+{
+    if( t < 0 || t >= length )
+        return( 0.0 );
+    if( t < ramp )
+        return( peak * t / ramp );
+    if( t > length - ramp )
+        return( peak * (length - t) / ramp );
+    return( peak );
+}
+
+static void
+PathSquare( long t, double *speed, double *rate )
+{
+    // 48 inch sides, 90 deg turns on the spot, 4 seconds a side
+    t = (t - kGyroTraceSettleMs) % 4000;
+    *speed = Trapezoid( t, 2500, 500, 48.0 / 2.0 );
+    *rate  = Trapezoid( t - 2800, 1000, 250, 90.0 / 0.75 );
+}
+
+static void
+PathCircle( long t, double *speed, double *rate )
+{
+    (void)t;
+    *speed = 24.0;
+    *rate  = 40.0;
+}
+
+static void
+PathSlalom( long t, double *speed, double *rate )
+{
+    *speed = 36.0;
+    *rate  = 90.0 * sin( 2.0 * PI * (t - kGyroTraceSettleMs) / 3000.0 );
+}
+
+static void
+PathArcs( long t, double *speed, double *rate )
+{
+    // fast arcs either way with short straights between
+    t = (t - kGyroTraceSettleMs) % 4000;
+    *speed = 48.0;
+    *rate  = Trapezoid( t, 1500, 150, 150.0 ) - Trapezoid( t - 2000, 1500, 150, 150.0 );
+}
+
+static  odomPath    paths[] = {
+    { "square",  "48 inch square, turns on the spot",   PathSquare },
+    { "circle",  "24 inch/sec, 40 deg/sec circle",      PathCircle },
+    { "slalom",  "36 inch/sec weaving +/- 90 deg/sec",  PathSlalom },
+    { "arcs",    "48 inch/sec, 150 deg/sec arcs",       PathArcs   },
+    };
+
+#define kNumbPaths  (int)(sizeof(paths) / sizeof(paths[0]))
+
+// Truth and encoders for one path, one entry per mS
+typedef struct _odomTruth {
+    std::vector<double> heading;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<int>    left;
+    std::vector<int>    right;
+    } odomTruth;
+
+static int
+EncoderSource( long timeMs, void *arg )
+{
+    std::vector<int> *counts = (std::vector<int> *)arg;
+
+    if( timeMs >= (long)counts->size() )
+        timeMs = (long)counts->size() - 1;
+    return( (*counts)[ timeMs ] );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Build the gyro trace, truth and encoder counts for a path       */
+/*-----------------------------------------------------------------------------*/
+
+static void
+OdomSynthesize( odomPath *p, long duration, gyroTrace *trace, odomTruth *truth )
+{
+    std::vector<double> rates( duration );
+    double  speed, rate;
+    double  heading = 0, x = 0, y = 0, left = 0, right = 0;
+    double  mid;
+    long    t;
+
+    truth->heading.resize( duration );
+    truth->x.resize( duration );
+    truth->y.resize( duration );
+    truth->left.resize( duration );
+    truth->right.resize( duration );
+
+    for(t=0;t<duration;t++)
+        {
+        speed = rate = 0;
+        if( t >= kGyroTraceSettleMs )
+            p->path( t, &speed, &rate );
+        rates[t] = rate;
+
+        truth->heading[t] = heading * 180.0 / PI;
+        truth->x[t]     = x;
+        truth->y[t]     = y;
+        truth->left[t]  = (int)floor( left  / kInchPerCount );
+        truth->right[t] = (int)floor( right / kInchPerCount );
+
+        // exact arc over the mS
+        rate  = rate * PI / 180.0;
+        mid   = heading + rate / 2000.0;
+        x    += speed / 1000.0 * cos( mid );
+        y    += speed / 1000.0 * sin( mid );
+        left  += (speed - rate * kTrack / 2.0) / 1000.0;
+        right += (speed + rate * kTrack / 2.0) / 1000.0;
+        heading += rate / 1000.0;
+        }
+
+    GyroTraceFromRate( trace, p->name, rates );
+}
+
+// Structure to hold the results for one path
+typedef struct _odomResult {
+    double  libFinal, libMax;
+    double  userFinal, userMax;
+    double  heading;                    ///< final gyro heading error in deg
+    } odomResult;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Run one path, library pose and user loop against the truth      */
+/*-----------------------------------------------------------------------------*/
+
+static void
+OdomRun( gyroTrace *trace, odomTruth *truth, int period, int backend, odomResult *r )
+{
+    long        duration = GyroTraceLengthGet( trace );
+    gyroPose    pose;
+    double      ux = 0, uy = 0;
+    long        ul = 0, ur = 0, l, rt;
+    bool        primed = false;
+    double      e;
+    long        now;
+    long        t;
+
+    RobotcReset();
+    RobotcSourceSet( in1, GyroTraceSource, trace );
+    RobotcSourceSet( dgtl1, EncoderSource, &truth->left );
+    RobotcSourceSet( dgtl3, EncoderSource, &truth->right );
+
+    GyroInit( in1, period, backend );
+    GyroOdometryInit( dgtl1, dgtl3, kInchPerCount );
+
+    r->libMax = r->userMax = 0;
+    r->libFinal = r->userFinal = 0;
+    r->heading  = 0;
+
+    for(t=0;t<duration;t+=kUserPeriod)
+        {
+        RobotcRun( kUserPeriod );
+
+        // what teams write, trig on the current heading every loop
+        l  = SensorValue[ dgtl1 ];
+        rt = SensorValue[ dgtl3 ];
+        if( GyroValidGet() )
+            {
+            if( primed )
+                {
+                e   = ((l - ul) + (rt - ur)) / 2.0 * kInchPerCount;
+                ux += e * cos( GyroAngleRadGet() );
+                uy += e * sin( GyroAngleRadGet() );
+                }
+            primed = true;
+            }
+        ul = l;
+        ur = rt;
+
+        GyroPoseGet( &pose );
+        if( !pose.valid )
+            continue;
+
+        // the trace holds its last sample after the end
+        if( pose.time >= duration )
+            pose.time = duration - 1;
+        now = (nSysTime < duration) ? nSysTime : duration - 1;
+
+        e = hypot( pose.x - truth->x[ pose.time ], pose.y - truth->y[ pose.time ] );
+        r->libMax   = fmax( r->libMax, e );
+        r->libFinal = e;
+        r->heading  = GyroAngleAbsGet() - truth->heading[ now ];
+
+        e = hypot( ux - truth->x[ now ], uy - truth->y[ now ] );
+        r->userMax   = fmax( r->userMax, e );
+        r->userFinal = e;
+        }
+}
+
+static double
+HostNs()
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( ts.tv_sec * 1e9 + ts.tv_nsec );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     The same update in float, for the cost comparison               */
+/*-----------------------------------------------------------------------------*/
+
+static  long    floatCount[2];
+static  float   floatHeading, floatX, floatY;
+
+static void
+FloatOdometryUpdate( int next )
+{
+    long    left  = SensorValue[ theGyros.odometry.port[0] ];
+    long    right = SensorValue[ theGyros.odometry.port[1] ];
+    float   heading = GyroAngleToRad( theGyros.sample[next].angle[0] );
+    float   d, dh, mid;
+
+    d  = ((left - floatCount[0]) + (right - floatCount[1])) * 0.5f * theGyros.odometry.scale;
+    dh = heading - floatHeading;
+    if( dh > PI )
+        dh -= 2 * PI;
+    if( dh < -PI )
+        dh += 2 * PI;
+    mid = floatHeading + dh * 0.5f;
+
+    floatX += d * cosf( mid );
+    floatY += d * sinf( mid );
+
+    floatCount[0] = left;
+    floatCount[1] = right;
+    floatHeading  = heading;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Host ns per update, best of kRepeats                            */
+/*-----------------------------------------------------------------------------*/
+
+static double
+OdomCost( bool fixed, odomTruth *truth )
+{
+    double  best = 1e9, t0;
+    int     next = (theGyros.sequence + 1) & 1;
+    long    i;
+    int     j;
+
+    for(j=0;j<kRepeats;j++)
+        {
+        t0 = HostNs();
+        for(i=0;i<kCostLoops;i++)
+            {
+            // a new heading and position every update
+            nSysTime = i % (long)truth->left.size();
+            theGyros.sample[next].angle[0] = GyroAngleFromValue( i % 3600 );
+            if( fixed )
+                GyroOdometryUpdate( next );
+            else
+                FloatOdometryUpdate( next );
+            }
+        best = fmin( best, (HostNs() - t0) / kCostLoops );
+        }
+
+    return( best );
+}
+
+static void
+Usage()
+{
+    fprintf( stderr, "usage: gyroOdom [-d ms] [-p ms] [-a]\n" );
+    fprintf( stderr, "  -d ms        path length, default 60000\n" );
+    fprintf( stderr, "  -p ms        GyroTask polling period, default %d\n", GYRO_PERIOD_DEFAULT );
+    fprintf( stderr, "  -a           use the raw analog backend\n" );
+    fprintf( stderr, "paths\n" );
+    for(int i=0;i<kNumbPaths;i++)
+        fprintf( stderr, "  %-12s %s\n", paths[i].name, paths[i].description );
+    exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+    long        duration = 60000;
+    int         period = GYRO_PERIOD_DEFAULT;
+    int         backend = kGyroBackendFirmware;
+    gyroTrace   trace;
+    odomTruth   truth;
+    odomResult  r;
+    bool        ok = true;
+    int         c, i;
+
+    while( (c = getopt( argc, argv, "d:p:a" )) != -1 )
+        {
+        switch( c )
+            {
+            case 'd': duration = atol( optarg ); break;
+            case 'p': period   = atoi( optarg ); break;
+            case 'a': backend  = kGyroBackendRaw; break;
+            default:  Usage();
+            }
+        }
+
+    printf( "%-8s %12s %12s %12s %12s %12s\n", "path", "lib final", "lib max", "user final", "user max", "heading" );
+
+    for(i=0;i<kNumbPaths;i++)
+        {
+        OdomSynthesize( &paths[i], duration, &trace, &truth );
+        OdomRun( &trace, &truth, period, backend, &r );
+
+        printf( "%-8s %9.2f in %9.2f in %9.2f in %9.2f in %8.2f deg\n", paths[i].name,
+                r.libFinal, r.libMax, r.userFinal, r.userMax, r.heading );
+
+        if( r.libMax > r.userMax + kSlackInch )
+            ok = false;
+        }
+
+    // the tasks are stopped, call the updates directly
+    stopTask( GyroTask );
+    stopTask( GyroRawTask );
+    printf( "update   %.1f ns fixed point table, %.1f ns float sin/cos\n",
+            OdomCost( true, &truth ), OdomCost( false, &truth ) );
+
+    printf( "%s\n", ok ? "PASS" : "FAIL" );
+    return( ok ? 0 : 1 );
+}
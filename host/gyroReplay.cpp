@@ -0,0 +1,313 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroReplay.cpp                                               */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include <time.h>
+#include <unistd.h>
+
+#include "robotc.h"
+#include "gyroTrace.h"
+
+#include "../gyroLib/gyroLib2.c"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroReplay.cpp
+  * @brief   Replay a gyro trace through gyroSim.c and gyroLib2.c on the host
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   The trace drives analog port in1.  GyroTask sets the port to sensorGyro
+ *   which starts the gyroSim firmware model, so both files see the data
+ *   exactly as they would on the cortex, only on a virtual clock.
+ *
+ *   gyroReplayTiming is built with GYRO_TIMING and reports how regularly
+ *   gyroSim and the polling task ran, use -j to see it go wrong.
+ */
+
+// With -j a quarter of all waits overrun
+#define kJitterPercent      25
+
+static void
+Usage()
+{
+    fprintf( stderr, "usage: gyroReplay [-f trace | -s synthetic] [-d ms] [-p ms] [-r ms] [-j ms] [-h ms] [-t file] [-e] [-a] [-v] [-l]\n" );
+    fprintf( stderr, "  -f trace      replay a trace file\n" );
+    fprintf( stderr, "  -s synthetic  replay a synthetic trace, one of\n" );
+    GyroTraceSyntheticList( stderr );
+    fprintf( stderr, "  -d ms         duration, default trace length or 120000\n" );
+    fprintf( stderr, "  -p ms         GyroTask polling period, default %d\n", GYRO_PERIOD_DEFAULT );
+    fprintf( stderr, "  -r ms         hot GyroReinit at this time\n" );
+    fprintf( stderr, "  -j ms         make %d%% of task waits overrun by up to ms\n", kJitterPercent );
+    fprintf( stderr, "  -h ms         check the heading history this far back every 20mS\n" );
+    fprintf( stderr, "  -t file       write the binary telemetry stream to file\n" );
+    fprintf( stderr, "  -e            use the drift estimator rather than the threshold\n" );
+    fprintf( stderr, "  -a            use the raw analog backend\n" );
+    fprintf( stderr, "  -v            print csv every 20mS\n" );
+    fprintf( stderr, "  -l            echo the LCD\n" );
+    exit( 1 );
+}
+
+#ifdef  GYRO_TIMING
+static void
+TimingPrint( const char *name, gyroTiming *t )
+{
+    int     i;
+
+    printf( "%-10s period %ld/%.2f/%ld mS min/mean/max, expected %ld, %ld overruns in %ld\n", name,
+            t->period_min, GyroTimingPeriodMean( t ), t->period_max, t->expected, t->overruns, t->count );
+    printf( "%-10s busy %.2f/%.2f uS mean/max\n", "",
+            GyroTimingBusyMean( t ) * 1000.0, t->busy_max * 1000.0 / GYRO_TIMING_TICKS_MS );
+    printf( "%-10s late", "" );
+    for(i=0;i<kGyroTimingBuckets;i++)
+        printf( " %ld", t->hist[i] );
+    printf( "  (0, 1, 2-3 ... 64+ mS)\n" );
+}
+#endif
+
+static double
+WallTime()
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( ts.tv_sec + ts.tv_nsec / 1e9 );
+}
+
+int
+main( int argc, char **argv )
+{
+    gyroTrace   trace;
+    gyroSnapshot snap;
+    const char *file = NULL;
+    const char *synthetic = "stationary";
+    long        duration = 0;
+    int         period = GYRO_PERIOD_DEFAULT;
+    long        reinit = -1;
+    int         jitter = 0;
+    int         drift = kGyroDriftThreshold;
+    int         backend = kGyroBackendFirmware;
+    bool        verbose = false;
+    bool        lcd = false;
+    long        history = -1;
+    const char *telemetry = NULL;
+    FILE       *tele = NULL;
+    double      histSq = 0, histMax = 0;
+    double      liveSq = 0, liveMax = 0;
+    double      histNs = 0;
+    long        recalStart = -1, recalEnd = -1;
+    double      recalFrom = 0, recalMoved = 0;
+    long        histN = 0, histMiss = 0;
+    float       past;
+    double      err;
+    double      wall;
+    long        t;
+    int         c;
+
+    while( (c = getopt( argc, argv, "f:s:d:p:r:j:h:t:eavl" )) != -1 )
+        {
+        switch( c )
+            {
+            case 'f': file      = optarg;         break;
+            case 's': synthetic = optarg;         break;
+            case 'd': duration  = atol( optarg ); break;
+            case 'p': period    = atoi( optarg ); break;
+            case 'r': reinit    = atol( optarg ); break;
+            case 'j': jitter    = atoi( optarg ); break;
+            case 'h': history   = atol( optarg ); break;
+            case 't': telemetry = optarg;         break;
+            case 'e': drift     = kGyroDriftEstimator; break;
+            case 'a': backend   = kGyroBackendRaw; break;
+            case 'v': verbose   = true;           break;
+            case 'l': lcd       = true;           break;
+            default:  Usage();
+            }
+        }
+
+    if( file != NULL )
+        {
+        if( !GyroTraceLoad( &trace, file ) )
+            {
+            fprintf( stderr, "gyroReplay: cannot load %s\n", file );
+            return( 1 );
+            }
+        if( duration <= 0 )
+            duration = GyroTraceLengthGet( &trace );
+        }
+    else
+        {
+        if( duration <= 0 )
+            duration = 120000;
+        if( !GyroTraceSynthesize( &trace, synthetic, duration ) )
+            Usage();
+        }
+
+    RobotcReset();
+    RobotcLcdEcho( lcd );
+    RobotcJitterSet( jitter, jitter ? kJitterPercent : 0 );
+    RobotcSourceSet( in1, GyroTraceSource, &trace );
+
+    if( telemetry != NULL )
+        {
+        if( (tele = fopen( telemetry, "wb" )) == NULL )
+            {
+            fprintf( stderr, "gyroReplay: cannot create %s\n", telemetry );
+            return( 1 );
+            }
+        RobotcUartFileSet( uartOne, tele );
+        }
+
+    GyroDriftModeSet( drift );
+    GyroInit( in1, period, backend );
+
+    wall = WallTime();
+    if( verbose || lcd || reinit >= 0 || history >= 0 || tele != NULL )
+        {
+        if( verbose )
+            printf( "time,adc,firmware,angle,abs_angle,rate,truth\n" );
+
+        for(t=0;t<duration;t+=20)
+            {
+            if( t == reinit - reinit % 20 )
+                {
+                GyroReinit( true );
+                recalStart = nSysTime;
+                recalFrom  = GyroTraceTruthGet( &trace, nSysTime );
+                }
+
+            RobotcRun( 20 );
+
+            // how far the trace turned while the robot should have been still
+            if( recalStart >= 0 && recalEnd < 0 )
+                {
+                err = GyroTraceTruthGet( &trace, nSysTime ) - recalFrom;
+                if( fabs( err ) > recalMoved )
+                    recalMoved = fabs( err );
+                if( GyroRecalDoneGet() )
+                    recalEnd = nSysTime;
+                }
+            if( verbose )
+                {
+                GyroSnapshotGet( &snap );
+                printf( "%ld,%d,%d,%.2f,%.2f,%.1f,%.2f\n", nSysTime,
+                        RobotcAnalogValue[ in1 ], SensorValue[ in1 ],
+                        snap.angle, snap.abs_angle, snap.rate,
+                        GyroTraceTruthGet( &trace, nSysTime ) );
+                }
+            if( lcd )
+                GyroDebug( 1 );
+            if( tele != NULL )
+                GyroTelemetrySend();
+
+            // heading a while ago from the history against the live heading now
+            if( history >= 0 && GyroTraceHasTruth( &trace ) && nSysTime > history )
+                {
+                double  t0 = WallTime();
+                bool    ok = GyroAngleAbsAt( nSysTime - history, &past );
+
+                histNs += (WallTime() - t0) * 1e9;
+                if( !ok )
+                    {
+                    histMiss++;
+                    continue;
+                    }
+                err = past - GyroTraceTruthGet( &trace, nSysTime - history );
+                histSq += err * err;
+                if( fabs( err ) > histMax )
+                    histMax = fabs( err );
+                err = GyroAngleAbsGet() - GyroTraceTruthGet( &trace, nSysTime );
+                liveSq += err * err;
+                if( fabs( err ) > liveMax )
+                    liveMax = fabs( err );
+                histN++;
+                }
+            }
+        }
+    else
+        RobotcRun( duration );
+    wall = WallTime() - wall;
+
+    printf( "trace      %s\n", trace.name );
+    printf( "virtual    %.3f s\n", duration / 1000.0 );
+    printf( "wall       %.3f s (%.0fx real time)\n", wall, duration / 1000.0 / wall );
+    printf( "valid      %s\n", GyroValidGet() ? "yes" : "no" );
+    printf( "gyroSim    %.1f deg\n", SensorValue[ in1 ] / 10.0 );
+    printf( "angle      %.2f deg\n", GyroAngleDegGet() );
+    printf( "abs_angle  %.2f deg\n", GyroAngleAbsGet() );
+    if( GyroTraceHasTruth( &trace ) )
+        {
+        printf( "truth      %.2f deg\n", GyroTraceTruthGet( &trace, nSysTime ) );
+        printf( "error      %.2f deg\n", GyroAngleAbsGet() - GyroTraceTruthGet( &trace, nSysTime ) );
+        }
+
+    if( recalStart >= 0 )
+        {
+        if( recalEnd >= 0 )
+            printf( "recal      done after %ld mS", recalEnd - recalStart );
+        else
+            printf( "recal      not done" );
+        if( GyroTraceHasTruth( &trace ) )
+            printf( ", trace turned %.1f deg meanwhile%s", recalMoved,
+                    (recalMoved > 1.0) ? ", it should have waited for GyroRecalDoneGet" : "" );
+        printf( "\n" );
+        }
+    if( lcd )
+        printf( "lcd        %ld writes\n", RobotcLcdWritesGet() );
+    if( tele != NULL )
+        {
+        printf( "telemetry  %ld bytes to %s, %ld records dropped\n",
+                RobotcUartBytesGet( uartOne ), telemetry, GyroTelemetryDroppedGet() );
+        fclose( tele );
+        }
+
+    if( history >= 0 && histN + histMiss > 0 )
+        {
+        printf( "history    %ld mS back, error %.2f/%.2f deg rms/max, live %.2f/%.2f, %ld missed\n",
+                history, histN ? sqrt( histSq / histN ) : 0.0, histMax, histN ? sqrt( liveSq / histN ) : 0.0, liveMax, histMiss );
+        printf( "history    %.0f nS per lookup\n", histNs / (histN + histMiss) );
+        }
+
+#ifdef  GYRO_TIMING
+    gyroTiming  timing;
+
+    if( backend == kGyroBackendFirmware && RobotcGyroFirmwareTimingGet( in1, &timing ) )
+        TimingPrint( "gyroSim", &timing );
+    GyroTaskTimingGet( &timing );
+    TimingPrint( backend == kGyroBackendRaw ? "GyroRaw" : "GyroTask", &timing );
+#endif
+
+    return( 0 );
+}
@@ -0,0 +1,147 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroStart.cpp                                                */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include "robotc.h"
+#include "gyroTrace.h"
+
+// gyroSim.c has its own sim::int32_t, keep it out of the global namespace
+namespace sim {
+
+// the test main in gyroSim.c is not used on the host
+#define main            gyroSimMain
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat"
+#include "../gyroLib/gyroSim.c"
+#pragma GCC diagnostic pop
+
+#undef  main
+
+}
+
+using sim::initGyro;
+using sim::gyroBiasGet;
+using sim::gyroValidGet;
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroStart.cpp
+  * @brief   Compare gyroSim start up, fixed, adaptive and warm start
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   gyroSim reads port in1 directly, the port is left as sensorNone so it
+ *   sees raw ADC values.  For each calibration mode we report how long until
+ *   the gyro is valid, the bias found and the heading error at the end of
+ *   the trace.  The warm start uses the bias from a cold calibration on a
+ *   different noise seed, as if saved from an earlier run.
+ */
+
+// Structure to hold one start up result
+typedef struct _startResult {
+    long    validMs;
+    double  bias;
+    double  error;
+    } startResult;
+
+static double
+StartWrap( double delta )
+{
+    delta = fmod( delta, 360.0 );
+    if( delta > 180.0 )
+        delta -= 360.0;
+    if( delta < -180.0 )
+        delta += 360.0;
+
+    return( delta );
+}
+
+static void
+StartRun( gyroTrace *trace, int mode, sim::int32_t bias, startResult *r )
+{
+    long    length = GyroTraceLengthGet( trace );
+
+    RobotcReset();
+    RobotcSourceSet( in1, GyroTraceSource, trace );
+
+    initGyro( in1, mode, bias );
+
+    r->validMs = -1;
+    while( nSysTime < length )
+        {
+        RobotcRun( 1 );
+        if( r->validMs < 0 && gyroValidGet() )
+            r->validMs = nSysTime;
+        }
+
+    r->bias  = gyroBiasGet() / 1024.0;
+    r->error = StartWrap( sim::GyroValue / 10.0 - GyroTraceTruthGet( trace, nSysTime ) );
+}
+
+int
+main( int argc, char **argv )
+{
+    const char *synthetic = argc > 1 ? argv[1] : "turns";
+    gyroTrace   trace;
+    gyroTrace   earlier;
+    startResult r;
+    sim::int32_t     stored;
+
+    if( !GyroTraceSynthesize( &trace, synthetic, 60000 ) ||
+        !GyroTraceSynthesize( &earlier, "stationary", 5000, 99 ) )
+        {
+        fprintf( stderr, "usage: gyroStart [synthetic]\n" );
+        GyroTraceSyntheticList( stderr );
+        return( 1 );
+        }
+
+    // bias saved from an earlier run
+    StartRun( &earlier, kGyroCalAdaptive, 0, &r );
+    stored = gyroBiasGet();
+
+    printf( "trace %s, true bias %d\n", trace.name, kGyroTraceBias );
+    printf( "%-10s %9s %9s %9s\n", "mode", "valid ms", "bias", "error" );
+
+    StartRun( &trace, kGyroCalFixed, 0, &r );
+    printf( "%-10s %9ld %9.3f %9.2f\n", "fixed", r.validMs, r.bias, r.error );
+    StartRun( &trace, kGyroCalAdaptive, 0, &r );
+    printf( "%-10s %9ld %9.3f %9.2f\n", "adaptive", r.validMs, r.bias, r.error );
+    StartRun( &trace, kGyroCalAdaptive, stored, &r );
+    printf( "%-10s %9ld %9.3f %9.2f\n", "warm", r.validMs, r.bias, r.error );
+
+    return( 0 );
+}
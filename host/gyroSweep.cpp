@@ -0,0 +1,735 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroSweep.cpp                                                */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "robotc.h"
+#include "gyroTrace.h"
+
+#include "../gyroLib/gyroLib2.c"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroSweep.cpp
+  * @brief   Parallel sweep of the gyro tuning parameters over a set of traces
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Every combination of the gyroSim dead band and bias sample count and the
+ *   GyroTask drift threshold and window is run through the firmware backend
+ *   for every trace, and the configurations are ranked by heading error.
+ *   Only the drift threshold and window can be set on the robot, the dead
+ *   band and sample count are fixed in the ROBOTC firmware and sweeping
+ *   them only shows what a different firmware would do.
+ *
+ *   -a sweeps the raw backend instead, whose dead band is the one that can
+ *   be changed on the robot with GyroRawJitterSet.  The drift threshold,
+ *   window and sample count do not apply to it and are not swept.
+ *
+ *   The library and the shim keep their state in globals so a job cannot
+ *   share a process with another one that is running.  The sweep forks one
+ *   worker per core instead, the traces are loaded first and shared copy on
+ *   write.  Each (config, trace) job is numbered and every worker starts
+ *   with an equal slice of the numbers.  A worker takes jobs from the front
+ *   of its own slice and when that is empty steals the back half of another
+ *   worker's, so long traces or slow configurations do not leave cores idle.
+ *   The slices and the results are in shared memory, a slice is one 64 bit
+ *   word so taking and stealing are both a single compare and swap.
+ *
+ *   Error is sampled every 20mS once the trace settle time is over, recorded
+ *   traces must also start with the robot still for kGyroTraceSettleMs.
+ *   Cost is host time in gyroSim and GyroTask per mS of robot time with the
+ *   task switch removed, it shows the trend but is noisy with every core
+ *   busy.  Timing every task switch about doubles the time a job takes, -q
+ *   skips it when only the error matters.  Configurations no other one
+ *   beats on both error and cost are marked with *.
+ *
+ *   Finally the first configuration is run again in this process and must
+ *   score exactly as it did in a worker.
+ */
+
+#define kSweepSample        20      ///< mS between error samples
+#define kSweepTop           20      ///< default rows in each table
+#define kSweepMaxWorkers    256
+
+// Structure to hold one set of parameters
+typedef struct _sweepConfig {
+    int     jitter;                 ///< gyroSim dead band, counts
+    int     threshold;              ///< GyroTask drift threshold, gyro units
+    int     window;                 ///< GyroTask drift window, mS
+    int     samples;                ///< gyroSim bias samples
+    } sweepConfig;
+
+// Structure to hold the result of one (config, trace) job
+typedef struct _sweepJob {
+    double  sq;                     ///< sum of squared error
+    long    n;                      ///< error samples
+    double  peak;                   ///< largest error
+    double  final;                  ///< error at the end of the trace
+    double  ns;                     ///< host nS per mS of robot time
+    bool    done;
+    } sweepJob;
+
+// Structure to hold one worker's slice of the job numbers, a cache line each
+typedef struct _sweepQueue {
+    std::atomic<unsigned long long> range;  ///< next job in the low 32 bits, end in the high
+    long    jobs;                           ///< jobs this worker ran
+    long    steals;                         ///< slices taken from other workers
+    char    pad[ 64 - 3 * sizeof(long) ];
+    } sweepQueue;
+
+// Structure to hold the combined results for one config
+typedef struct _sweepScore {
+    int     config;
+    double  rms;                    ///< mean over traces of the rms error
+    double  peak;                   ///< worst error on any trace
+    double  final;                  ///< mean over traces of the final error
+    double  ns;                     ///< mean cost
+    bool    front;                  ///< not beaten on both error and cost
+    } sweepScore;
+
+static  std::vector<gyroTrace>      traces;
+static  std::vector<sweepConfig>    configs;
+static  sweepJob                   *jobs = NULL;
+static  sweepQueue                 *queues = NULL;
+static  int         period = GYRO_PERIOD_DEFAULT;
+static  double      overhead = 0;
+static  bool        costs = true;
+static  int         backend = kGyroBackendFirmware;
+
+static  const char *corpus[] = { "stationary", "slowspin", "spin", "turns", "vibration" };
+
+#define kCorpusSize (int)(sizeof(corpus) / sizeof(corpus[0]))
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     A task that does nothing, used to measure the switch overhead   */
+/*-----------------------------------------------------------------------------*/
+
+task NullTask()
+{
+    while(true)
+        wait1Msec(1);
+}
+
+static double
+SweepOverhead()
+{
+    long    runs;
+    double  seconds;
+    double  best = 1e9;
+    int     i;
+
+    for(i=0;i<5;i++)
+        {
+        RobotcReset();
+        RobotcTimingEnable( true );
+        startTask( NullTask );
+        RobotcRun( 100000 );
+        RobotcTaskStatsGet( NullTask, &runs, &seconds );
+        stopTask( NullTask );
+
+        if( seconds / runs < best )
+            best = seconds / runs;
+        }
+
+    RobotcTimingEnable( false );
+    return( best );
+}
+
+static double
+WallTime()
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( ts.tv_sec + ts.tv_nsec / 1e9 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Run one (config, trace) job                                     */
+/** @param[in] job the job number, config * traces + trace                     */
+/** @param[out] r the result                                                   */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SweepRun( long job, sweepJob *r )
+{
+    sweepConfig *c = &configs[ job / traces.size() ];
+    gyroTrace   *trace = &traces[ job % traces.size() ];
+    long        length = GyroTraceLengthGet( trace );
+    long        runs;
+    double      seconds, busy = 0;
+    double      error = 0;
+    long        t;
+
+    RobotcReset();
+    RobotcTimingEnable( costs );
+    RobotcSourceSet( in1, GyroTraceSource, trace );
+    RobotcGyroFirmwareParamsSet( in1, c->jitter, c->samples );
+
+    GyroDriftModeSet( kGyroDriftThreshold );
+    GyroDriftParamsSet( c->threshold, c->window );
+    GyroRawJitterSet( c->jitter );
+    GyroInit( in1, period, backend );
+
+    r->sq   = 0;
+    r->n    = 0;
+    r->peak = 0;
+
+    for(t=0;t<length;t+=kSweepSample)
+        {
+        RobotcRun( kSweepSample );
+        if( nSysTime < kGyroTraceSettleMs )
+            continue;
+
+        error  = GyroAngleAbsGet() - GyroTraceTruthGet( trace, nSysTime );
+        r->sq += error * error;
+        r->n++;
+        if( fabs( error ) > r->peak )
+            r->peak = fabs( error );
+        }
+    r->final = error;
+
+    if( costs && RobotcTaskStatsGet( RobotcGyroFirmwareTaskGet( in1 ), &runs, &seconds ) )
+        busy += seconds - runs * overhead;
+    if( costs && RobotcTaskStatsGet( GyroTask, &runs, &seconds ) )
+        busy += seconds - runs * overhead;
+    if( costs && RobotcTaskStatsGet( GyroRawTask, &runs, &seconds ) )
+        busy += seconds - runs * overhead;
+    r->ns   = busy * 1e9 / nSysTime;
+    r->done = true;
+
+    RobotcTimingEnable( false );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Job queues, a slice of job numbers packed in one word           */
+/*-----------------------------------------------------------------------------*/
+
+static inline unsigned long long
+SweepPack( unsigned int next, unsigned int end )
+{
+    return( ((unsigned long long)end << 32) | next );
+}
+
+/// take the next job from the front of our own slice, -1 if it is empty
+static long
+SweepPop( sweepQueue *q )
+{
+    unsigned long long  r = q->range.load();
+    unsigned int        next, end;
+
+    do  {
+        next = (unsigned int)r;
+        end  = (unsigned int)(r >> 32);
+        if( next >= end )
+            return( -1 );
+        } while( !q->range.compare_exchange_weak( r, SweepPack( next + 1, end ) ) );
+
+    return( next );
+}
+
+/// take the back half of another worker's slice, the owner keeps the front
+static bool
+SweepSteal( sweepQueue *q, unsigned int *lo, unsigned int *hi )
+{
+    unsigned long long  r = q->range.load();
+    unsigned int        next, end, split;
+
+    do  {
+        next = (unsigned int)r;
+        end  = (unsigned int)(r >> 32);
+        if( next >= end )
+            return( false );
+        split = end - (end - next + 1) / 2;
+        } while( !q->range.compare_exchange_weak( r, SweepPack( next, split ) ) );
+
+    *lo = split;
+    *hi = end;
+    return( true );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     One worker, runs until every slice is empty                     */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SweepWorker( int id, int nWorkers )
+{
+    sweepQueue     *own = &queues[id];
+    unsigned int    lo, hi;
+    long            job;
+    int             k;
+
+    while( true )
+        {
+        if( (job = SweepPop( own )) < 0 )
+            {
+            // look for work starting with the next worker round
+            for(k=1;k<nWorkers;k++)
+                if( SweepSteal( &queues[ (id + k) % nWorkers ], &lo, &hi ) )
+                    break;
+            if( k >= nWorkers )
+                return;
+
+            // our slice is empty so nobody else changes it, run the first
+            // stolen job and make the rest stealable again
+            own->range.store( SweepPack( lo + 1, hi ) );
+            own->steals++;
+            job = lo;
+            }
+
+        SweepRun( job, &jobs[job] );
+        own->jobs++;
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Parse a parameter list, a,b,c or lo:hi or lo:hi:step            */
+/*-----------------------------------------------------------------------------*/
+
+static bool
+SweepList( const char *arg, std::vector<int> &values )
+{
+    int     lo, hi, step = 1;
+    int     used;
+    int     v;
+
+    values.clear();
+
+    if( sscanf( arg, "%d:%d%n", &lo, &hi, &used ) == 2 )
+        {
+        if( arg[used] == ':' && sscanf( arg + used + 1, "%d", &step ) != 1 )
+            return( false );
+        if( step <= 0 || hi < lo )
+            return( false );
+        for(v=lo;v<=hi;v+=step)
+            values.push_back( v );
+        return( true );
+        }
+
+    while( sscanf( arg, "%d%n", &v, &used ) == 1 )
+        {
+        values.push_back( v );
+        arg += used;
+        if( *arg != ',' )
+            break;
+        arg++;
+        }
+
+    return( *arg == 0 && !values.empty() );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Load every trace with a heading from a directory                */
+/*-----------------------------------------------------------------------------*/
+
+static void
+SweepTraceAdd( const char *filename )
+{
+    gyroTrace   trace;
+
+    if( !GyroTraceLoad( &trace, filename ) || !GyroTraceHasTruth( &trace ) )
+        {
+        fprintf( stderr, "gyroSweep: %s has no heading, skipped\n", filename );
+        return;
+        }
+    traces.push_back( trace );
+}
+
+static bool
+SweepTraceDir( const char *dir )
+{
+    std::vector<std::string>    names;
+    struct dirent  *e;
+    DIR            *d;
+    size_t          i;
+
+    if( (d = opendir( dir )) == NULL )
+        return( false );
+    while( (e = readdir( d )) != NULL )
+        if( e->d_name[0] != '.' )
+            names.push_back( std::string( dir ) + "/" + e->d_name );
+    closedir( d );
+
+    std::sort( names.begin(), names.end() );
+    for(i=0;i<names.size();i++)
+        SweepTraceAdd( names[i].c_str() );
+
+    return( true );
+}
+
+static bool
+SweepByError( const sweepScore &a, const sweepScore &b )
+{
+    if( a.rms != b.rms )
+        return( a.rms < b.rms );
+    return( a.ns < b.ns );
+}
+
+static bool
+SweepByCost( const sweepScore &a, const sweepScore &b )
+{
+    if( a.ns != b.ns )
+        return( a.ns < b.ns );
+    return( a.rms < b.rms );
+}
+
+static void
+SweepPrint( FILE *fp, int rank, const sweepScore *s )
+{
+    const sweepConfig  *c = &configs[ s->config ];
+
+    if( backend == kGyroBackendRaw )
+        fprintf( fp, "%5d %6d %6s %6s %7s %8.2f %8.2f %8.2f ", rank,
+                 c->jitter, "-", "-", "-", s->rms, s->peak, s->final );
+    else
+        fprintf( fp, "%5d %6d %6d %6d %7d %8.2f %8.2f %8.2f ", rank,
+                 c->jitter, c->threshold, c->window, c->samples, s->rms, s->peak, s->final );
+    if( costs )
+        fprintf( fp, "%8.1f %s\n", s->ns, s->front ? "*" : "" );
+    else
+        fprintf( fp, "%8s\n", "-" );
+}
+
+static void
+SweepHeader( FILE *fp )
+{
+    fprintf( fp, "%5s %6s %6s %6s %7s %8s %8s %8s %8s\n", "rank",
+             "jitter", "thresh", "window", "samples", "rms err", "peak err", "final", "ns/mS" );
+}
+
+static void
+Usage()
+{
+    fprintf( stderr, "usage: gyroSweep [-D dir] [-d ms] [-p ms] [-w workers] [-n rows] [-o csv] [-q] [-a]\n" );
+    fprintf( stderr, "                 [-J list] [-T list] [-W list] [-B list] [trace files...]\n" );
+    fprintf( stderr, "  -D dir        every trace file in dir, default the synthetic corpus\n" );
+    fprintf( stderr, "  -d ms         synthetic trace length, default 20000\n" );
+    fprintf( stderr, "  -p ms         GyroTask polling period, default %d\n", GYRO_PERIOD_DEFAULT );
+    fprintf( stderr, "  -w workers    default one per core\n" );
+    fprintf( stderr, "  -n rows       rows in each table, default %d\n", kSweepTop );
+    fprintf( stderr, "  -o csv        write every configuration to a csv file\n" );
+    fprintf( stderr, "  -q            quick, do not measure costs\n" );
+    fprintf( stderr, "  -a            sweep the raw backend dead band, -T -W -B do not apply\n" );
+    fprintf( stderr, "  -J list       gyroSim dead band, default 0:8\n" );
+    fprintf( stderr, "  -T list       drift threshold, default 1:8\n" );
+    fprintf( stderr, "  -W list       drift window mS, default 125,250,500,1000\n" );
+    fprintf( stderr, "  -B list       bias samples, default 256,512,1024,2048\n" );
+    fprintf( stderr, "  a list is a,b,c or lo:hi or lo:hi:step\n" );
+    exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+    const char     *dir = NULL;
+    const char     *csv = NULL;
+    long            duration = 20000;
+    int             nWorkers = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    int             rows = kSweepTop;
+    std::vector<int> jitters, thresholds, windows, samples;
+    std::vector<sweepScore> scores;
+    sweepConfig     config;
+    sweepJob        check;
+    sweepScore      s;
+    size_t          nJobs, bytes;
+    std::vector<pid_t> pids;
+    pid_t           pid;
+    long            steals = 0;
+    long            failed = 0;
+    double          wall, best;
+    bool            ok = true;
+    FILE           *fp;
+    int             status;
+    size_t          i, j, k, l;
+    int             c;
+
+    SweepList( "0:8", jitters );
+    SweepList( "1:8", thresholds );
+    SweepList( "125,250,500,1000", windows );
+    SweepList( "256,512,1024,2048", samples );
+
+    while( (c = getopt( argc, argv, "D:d:p:w:n:o:qaJ:T:W:B:" )) != -1 )
+        {
+        switch( c )
+            {
+            case 'D': dir      = optarg;         break;
+            case 'd': duration = atol( optarg ); break;
+            case 'p': period   = atoi( optarg ); break;
+            case 'w': nWorkers = atoi( optarg ); break;
+            case 'n': rows     = atoi( optarg ); break;
+            case 'o': csv      = optarg;         break;
+            case 'q': costs    = false;          break;
+            case 'a': backend  = kGyroBackendRaw; break;
+            case 'J': if( !SweepList( optarg, jitters ) )    Usage(); break;
+            case 'T': if( !SweepList( optarg, thresholds ) ) Usage(); break;
+            case 'W': if( !SweepList( optarg, windows ) )    Usage(); break;
+            case 'B': if( !SweepList( optarg, samples ) )    Usage(); break;
+            default:  Usage();
+            }
+        }
+
+    // the raw backend has no drift threshold or firmware calibration
+    if( backend == kGyroBackendRaw )
+        {
+        thresholds.assign( 1, GYRO_DRIFT_THRESHOLD );
+        windows.assign( 1, GYRO_DRIFT_WINDOW );
+        samples.assign( 1, 1024 );
+        }
+
+    if( nWorkers < 1 )
+        nWorkers = 1;
+    if( nWorkers > kSweepMaxWorkers )
+        nWorkers = kSweepMaxWorkers;
+
+    // traces
+    if( dir != NULL && !SweepTraceDir( dir ) )
+        {
+        fprintf( stderr, "gyroSweep: cannot read %s\n", dir );
+        return( 1 );
+        }
+    for(i=optind;i<(size_t)argc;i++)
+        SweepTraceAdd( argv[i] );
+    if( dir == NULL && optind == argc )
+        {
+        traces.resize( kCorpusSize );
+        for(i=0;i<traces.size();i++)
+            GyroTraceSynthesize( &traces[i], corpus[i], duration );
+        }
+    if( traces.empty() )
+        {
+        fprintf( stderr, "gyroSweep: no traces with a heading\n" );
+        return( 1 );
+        }
+
+    // every combination
+    for(i=0;i<jitters.size();i++)
+        for(j=0;j<thresholds.size();j++)
+            for(k=0;k<windows.size();k++)
+                for(l=0;l<samples.size();l++)
+                    {
+                    config.jitter    = jitters[i];
+                    config.threshold = thresholds[j];
+                    config.window    = windows[k];
+                    config.samples   = samples[l];
+                    configs.push_back( config );
+                    }
+
+    nJobs = configs.size() * traces.size();
+    if( nJobs >= 0xFFFFFFFFUL )
+        {
+        fprintf( stderr, "gyroSweep: too many jobs\n" );
+        return( 1 );
+        }
+    if( (size_t)nWorkers > nJobs )
+        nWorkers = (int)nJobs;
+
+    overhead = SweepOverhead();
+
+    // queues and results shared with the workers
+    bytes  = nWorkers * sizeof(sweepQueue) + nJobs * sizeof(sweepJob);
+    queues = (sweepQueue *)mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+    if( queues == MAP_FAILED )
+        {
+        fprintf( stderr, "gyroSweep: cannot map %zu bytes\n", bytes );
+        return( 1 );
+        }
+    jobs = (sweepJob *)(queues + nWorkers);
+
+    for(c=0;c<nWorkers;c++)
+        {
+        new (&queues[c].range) std::atomic<unsigned long long>(
+            SweepPack( (unsigned int)(nJobs * c / nWorkers), (unsigned int)(nJobs * (c + 1) / nWorkers) ) );
+        queues[c].jobs   = 0;
+        queues[c].steals = 0;
+        }
+
+    printf( "%zu traces, %zu configurations, %zu jobs on %d workers\n",
+            traces.size(), configs.size(), nJobs, nWorkers );
+    if( backend == kGyroBackendRaw )
+        printf( "raw backend, jitter is GyroRawJitterSet on the robot\n" );
+    else
+        printf( "firmware backend, thresh and window are GyroDriftParamsSet on the robot,\n"
+                "jitter and samples only change the host firmware model\n" );
+    fflush( stdout );
+
+    wall = WallTime();
+    for(c=0;c<nWorkers;c++)
+        {
+        if( (pid = fork()) < 0 )
+            {
+            perror( "gyroSweep: fork" );
+            return( 1 );
+            }
+        if( pid == 0 )
+            {
+            SweepWorker( c, nWorkers );
+            _exit( 0 );
+            }
+        pids.push_back( pid );
+        }
+
+    for(i=0;i<pids.size();i++)
+        {
+        if( waitpid( pids[i], &status, 0 ) < 0 || !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 )
+            {
+            fprintf( stderr, "gyroSweep: worker %zu failed\n", i );
+            ok = false;
+            }
+        }
+    wall = WallTime() - wall;
+
+    for(c=0;c<nWorkers;c++)
+        steals += queues[c].steals;
+    for(i=0;i<nJobs;i++)
+        if( !jobs[i].done )
+            failed++;
+
+    printf( "%.2f s wall, %.0f configurations/s, %ld steals, %ld jobs not run\n",
+            wall, configs.size() / wall, steals, failed );
+
+    // combine the traces for each config
+    for(i=0;i<configs.size();i++)
+        {
+        s.config = (int)i;
+        s.rms = s.peak = s.final = s.ns = 0;
+        s.front = false;
+        for(j=0;j<traces.size();j++)
+            {
+            sweepJob   *r = &jobs[ i * traces.size() + j ];
+
+            s.rms   += r->n ? sqrt( r->sq / r->n ) : 0;
+            s.peak   = fmax( s.peak, r->peak );
+            s.final += fabs( r->final );
+            s.ns    += r->ns;
+            }
+        s.rms   /= traces.size();
+        s.final /= traces.size();
+        s.ns    /= traces.size();
+        scores.push_back( s );
+        }
+
+    // cheapest first, anything more accurate than all cheaper ones is on the front
+    std::sort( scores.begin(), scores.end(), SweepByCost );
+    best = 1e9;
+    for(i=0;costs && i<scores.size();i++)
+        {
+        if( scores[i].rms < best )
+            {
+            best = scores[i].rms;
+            scores[i].front = true;
+            }
+        }
+
+    printf( "\nmost accurate\n" );
+    SweepHeader( stdout );
+    std::sort( scores.begin(), scores.end(), SweepByError );
+    for(i=0;i<scores.size() && (int)i<rows;i++)
+        SweepPrint( stdout, (int)i + 1, &scores[i] );
+
+    if( costs )
+        {
+        printf( "\nerror against cost, cheapest first\n" );
+        SweepHeader( stdout );
+        }
+    for(i=0,j=0;costs && i<scores.size() && (int)j<rows;i++)
+        {
+        if( !scores[i].front )
+            continue;
+        for(k=0;k<scores.size();k++)
+            if( scores[k].config == scores[i].config )
+                break;
+        SweepPrint( stdout, (int)k + 1, &scores[i] );
+        j++;
+        }
+
+    // defaults, if they were in the grid
+    for(i=0;i<scores.size();i++)
+        {
+        config = configs[ scores[i].config ];
+        if( config.jitter == GYRO_RAW_JITTER && config.threshold == GYRO_DRIFT_THRESHOLD &&
+            config.window == GYRO_DRIFT_WINDOW && config.samples == 1024 )
+            {
+            printf( "\ndefaults\n" );
+            SweepPrint( stdout, (int)i + 1, &scores[i] );
+            }
+        }
+
+    if( csv != NULL )
+        {
+        if( (fp = fopen( csv, "w" )) == NULL )
+            {
+            fprintf( stderr, "gyroSweep: cannot create %s\n", csv );
+            return( 1 );
+            }
+        fprintf( fp, "rank,jitter,threshold,window,samples,rms_err,peak_err,final_err,ns_per_ms,front\n" );
+        for(i=0;i<scores.size();i++)
+            {
+            config = configs[ scores[i].config ];
+            fprintf( fp, "%zu,%d,%d,%d,%d,%.4f,%.4f,%.4f,%.2f,%d\n", i + 1,
+                     config.jitter, config.threshold, config.window, config.samples,
+                     scores[i].rms, scores[i].peak, scores[i].final, scores[i].ns, scores[i].front );
+            }
+        fclose( fp );
+        }
+
+    // a worker must score exactly as this process does
+    SweepRun( 0, &check );
+    if( check.sq != jobs[0].sq || check.peak != jobs[0].peak || check.final != jobs[0].final )
+        {
+        printf( "worker and serial runs differ, rms %.4f and %.4f\n",
+                sqrt( jobs[0].sq / jobs[0].n ), sqrt( check.sq / check.n ) );
+        ok = false;
+        }
+    if( failed != 0 )
+        ok = false;
+
+    munmap( queues, bytes );
+
+    printf( "%s\n", ok ? "PASS" : "FAIL" );
+    return( ok ? 0 : 1 );
+}
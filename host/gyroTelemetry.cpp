@@ -0,0 +1,186 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroTelemetry.cpp                                            */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include "robotc.h"
+
+#define GYRO_TELEMETRY
+#include "../gyroLib/gyroTelemetry.h"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroTelemetry.cpp
+  * @brief   Decode a binary gyro telemetry stream into csv
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Reads what GyroTelemetrySend wrote to the serial port, from a file or
+ *   stdin, and prints one csv line per record.  A record with the wrong
+ *   check is skipped a byte at a time until the next good one, so a capture
+ *   can start part way through the stream.  Counts of records, bad bytes and
+ *   records missing from the sequence go to stderr.
+ *
+ *   Firmware backend values are in degrees, raw backend values in ADC
+ *   counts.  nSysTime is only sent as 16 bits, gaps of over a minute are
+ *   not allowed for.
+ */
+
+/// One decoded record
+typedef struct _gyroTeleRecord {
+    int         gyro;
+    int         flags;
+    int         sequence;
+    long        time;
+    int         raw;
+    int         filtered;
+    int         drift;
+    long        angle;
+    } gyroTeleRecord;
+
+static int
+Get16( const unsigned char *p )
+{
+    return( (short)(p[0] | (p[1] << 8)) );
+}
+
+static long
+Get32( const unsigned char *p )
+{
+    return( (int)(p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24)) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      Decode one record                                              */
+/** @param[in]  p kGyroTeleRecordSize bytes                                    */
+/** @param[out] r the record                                                   */
+/** @returns    false if this is not a good record                            */
+/*-----------------------------------------------------------------------------*/
+
+static bool
+GyroTeleDecode( const unsigned char *p, gyroTeleRecord *r )
+{
+    unsigned char   sum = 0;
+    int             i;
+
+    if( p[0] != kGyroTeleSync )
+        return( false );
+    for(i=0;i<kGyroTeleRecordSize;i++)
+        sum += p[i];
+    if( sum != 0 )
+        return( false );
+
+    r->gyro     = p[1] & kGyroTeleGyroMask;
+    r->flags    = p[1];
+    r->sequence = p[2];
+    r->time     = p[4] | (p[5] << 8);
+    r->raw      = Get16( &p[6] );
+    r->filtered = Get16( &p[8] );
+    r->drift    = Get16( &p[10] );
+    r->angle    = Get32( &p[12] );
+    return( true );
+}
+
+int
+main( int argc, char **argv )
+{
+    FILE           *fp = stdin;
+    unsigned char   buf[ kGyroTeleRecordSize ];
+    gyroTeleRecord  r;
+    int             n = 0;
+    long            records = 0;
+    long            bad = 0;
+    long            missing = 0;
+    int             sequence = -1;
+    long            time = -1;
+
+    if( argc > 2 )
+        {
+        fprintf( stderr, "usage: gyroTelemetry [file]\n" );
+        return( 1 );
+        }
+    if( argc == 2 && (fp = fopen( argv[1], "rb" )) == NULL )
+        {
+        fprintf( stderr, "gyroTelemetry: cannot open %s\n", argv[1] );
+        return( 1 );
+        }
+
+    printf( "time,gyro,backend,valid,raw,filtered,drift,abs_angle\n" );
+
+    for(;;)
+        {
+        // fill the window
+        while( n < kGyroTeleRecordSize )
+            {
+            int c = fgetc( fp );
+            if( c == EOF )
+                break;
+            buf[n++] = c;
+            }
+        if( n < kGyroTeleRecordSize )
+            break;
+
+        if( !GyroTeleDecode( buf, &r ) )
+            {
+            // slide on one byte and look again
+            memmove( buf, buf + 1, --n );
+            bad++;
+            continue;
+            }
+        n = 0;
+
+        // records lost between this and the last good one
+        if( sequence >= 0 )
+            missing += (r.sequence - sequence - 1) & 0xFF;
+        sequence = r.sequence;
+
+        // put back the top bits of nSysTime
+        time = (time < 0) ? r.time : time + ((r.time - time) & 0xFFFF);
+
+        if( r.flags & kGyroTeleRaw )
+            printf( "%ld,%d,raw,%d,%d,%d,%.3f,%.2f\n", time, r.gyro, (r.flags & kGyroTeleValid) ? 1 : 0,
+                    r.raw, r.filtered, r.drift / 8.0, r.angle / 100.0 );
+        else
+            printf( "%ld,%d,firmware,%d,%.1f,%.1f,%.1f,%.2f\n", time, r.gyro, (r.flags & kGyroTeleValid) ? 1 : 0,
+                    r.raw / 10.0, r.filtered / 10.0, r.drift / 10.0, r.angle / 100.0 );
+        records++;
+        }
+
+    fprintf( stderr, "gyroTelemetry: %ld records, %ld bad bytes, %ld missing\n", records, bad + n, missing );
+
+    if( fp != stdin )
+        fclose( fp );
+    return( 0 );
+}
@@ -0,0 +1,439 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroTrace.cpp                                                */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include "robotc.h"
+#include "gyroTrace.h"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroTrace.cpp
+  * @brief   Trace loading, synthesis and playback into a sensor port
+*//*---------------------------------------------------------------------------*/
+
+// Motion profile, returns the true rate in deg/sec at a given time
+typedef double  (*tGyroProfile)( long timeMs );
+
+// Vibration added on top of a profile, deg/sec at a time in seconds
+typedef double  (*tGyroVibration)( double time );
+
+// Change in the zero rate ADC value, counts at a given time
+typedef double  (*tGyroBias)( long timeMs );
+
+// Structure to hold a named synthetic trace
+typedef struct _gyroSynthetic {
+    const char     *name;
+    const char     *description;
+    tGyroProfile    profile;
+    tGyroVibration  vibration;      ///< NULL for none
+    tGyroBias       bias;           ///< NULL for a constant bias
+    } gyroSynthetic;
+
+// ADC noise, standard deviation in counts
+#define kNoiseCounts    1.5
+
+static double
+ProfileStationary( long timeMs )
+{
+    (void)timeMs;
+    return( 0.0 );
+}
+
+static double
+ProfileSpin( long timeMs )
+{
+    return( timeMs < kGyroTraceSettleMs ? 0.0 : 30.0 );
+}
+
+static double
+ProfileSlowSpin( long timeMs )
+{
+    return( timeMs < kGyroTraceSettleMs ? 0.0 : 2.0 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Trapezoidal 90 deg turns every 3 seconds                        */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   300 deg/sec peak, 100mS ramps and 200mS at full rate, the direction
+ *   follows a fixed pattern so the net heading wanders rather than winds up.
+ */
+
+static double
+ProfileTurns( long timeMs )
+{
+    static const signed char pattern[] = { 1, 1, -1, 1, -1, -1, -1, 1 };
+    long    t, n;
+    double  rate;
+
+    if( timeMs < kGyroTraceSettleMs )
+        return( 0.0 );
+
+    t = (timeMs - kGyroTraceSettleMs) % 3000;
+    n = (timeMs - kGyroTraceSettleMs) / 3000;
+
+    if( t < 100 )
+        rate = 300.0 * t / 100.0;
+    else
+    if( t < 300 )
+        rate = 300.0;
+    else
+    if( t < 400 )
+        rate = 300.0 * (400 - t) / 100.0;
+    else
+        rate = 0.0;
+
+    return( rate * pattern[ n % (long)sizeof(pattern) ] );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Driving with drivetrain vibration                               */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   A 27Hz 40 deg/sec rocking on top of gentle 2 second curves, the rocking
+ *   integrates to nothing but is large enough to cross the jitter band.
+ */
+
+static double
+ProfileVibration( long timeMs )
+{
+    double  rate;
+    long    t;
+
+    if( timeMs < kGyroTraceSettleMs )
+        return( 0.0 );
+
+    t = timeMs - kGyroTraceSettleMs;
+
+    rate = 40.0 * sin( 2.0 * PI * 27.0 * t / 1000.0 );
+
+    switch( (t / 2000) % 4 )
+        {
+        case 1: rate += 15.0; break;
+        case 3: rate -= 15.0; break;
+        default: break;
+        }
+
+    return( rate );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Driving with vibration close to multiples of 1kHz               */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The gentle curves of ProfileVibration with drivetrain vibration at
+ *   1002Hz and 2997Hz.  Read once a mS these alias to 2Hz and 3Hz swings of
+ *   several degrees that the true heading does not have.  Neither appears
+ *   until the settle time is over.
+ */
+
+static double
+ProfileChassis( long timeMs )
+{
+    if( timeMs < kGyroTraceSettleMs )
+        return( 0.0 );
+
+    switch( ((timeMs - kGyroTraceSettleMs) / 2000) % 4 )
+        {
+        case 1: return(  15.0 );
+        case 3: return( -15.0 );
+        default: return( 0.0 );
+        }
+}
+
+static double
+VibrationChassis( double time )
+{
+    if( time < kGyroTraceSettleMs / 1000.0 )
+        return( 0.0 );
+
+    return( 45.0 * sin( 2.0 * PI * 1002.0 * time ) + 30.0 * sin( 2.0 * PI * 2997.0 * time ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Bias that walks as the sensor warms up                          */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Nothing changes until the settle time is over so calibration sees the
+ *   starting bias.  After that it rises towards 2 counts with a one minute
+ *   time constant and wanders half a count either way over 45 seconds, a
+ *   few deg/sec of drift at most and always changing.
+ */
+
+static double
+BiasWalk( long timeMs )
+{
+    double  t;
+
+    if( timeMs < kGyroTraceSettleMs )
+        return( 0.0 );
+
+    t = (timeMs - kGyroTraceSettleMs) / 1000.0;
+
+    return( 2.0 * (1.0 - exp( -t / 60.0 )) + 0.5 * sin( 2.0 * PI * t / 45.0 ) );
+}
+
+static  gyroSynthetic   synthetics[] = {
+    { "stationary", "robot does not move",                  ProfileStationary, NULL,             NULL },
+    { "slowspin",   "constant 2 deg/sec after settle",      ProfileSlowSpin,   NULL,             NULL },
+    { "spin",       "constant 30 deg/sec after settle",     ProfileSpin,       NULL,             NULL },
+    { "turns",      "fast 90 deg turns every 3 seconds",    ProfileTurns,      NULL,             NULL },
+    { "vibration",  "driving curves with 27Hz vibration",   ProfileVibration,  NULL,             NULL },
+    { "chassis",    "driving curves with 1kHz vibration",   ProfileChassis,    VibrationChassis, NULL },
+    { "biaswalk",   "fast turns while the bias drifts",     ProfileTurns,      NULL,             BiasWalk },
+    };
+
+#define kNumbSynthetics (int)(sizeof(synthetics) / sizeof(synthetics[0]))
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Simple repeatable gaussian noise source                         */
+/*-----------------------------------------------------------------------------*/
+
+static double
+GyroTraceNoise( unsigned int *seed )
+{
+    double  u1, u2;
+
+    // LCG so every host gives the same trace for the same seed
+    *seed = *seed * 1103515245 + 12345;
+    u1 = ((*seed >> 8) + 1.0) / 16777217.0;
+    *seed = *seed * 1103515245 + 12345;
+    u2 = (*seed >> 8) / 16777216.0;
+
+    return( sqrt( -2.0 * log( u1 ) ) * cos( 2.0 * PI * u2 ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Load a trace from a text file                                   */
+/** @param[in] trace the trace to fill                                         */
+/** @param[in] filename the file                                              */
+/** @returns   true on success                                                 */
+/*-----------------------------------------------------------------------------*/
+
+bool
+GyroTraceLoad( gyroTrace *trace, const char *filename )
+{
+    FILE   *fp;
+    char    line[128];
+    long    t;
+    int     adc;
+    float   heading;
+    int     n;
+    bool    hasTruth = true;
+    const char *base;
+
+    if( (fp = fopen( filename, "r" )) == NULL )
+        return( false );
+
+    trace->adc.clear();
+    trace->truth.clear();
+    trace->perMs = 1;
+
+    base = strrchr( filename, '/' );
+    snprintf( trace->name, sizeof(trace->name), "%s", base ? base + 1 : filename );
+
+    while( fgets( line, sizeof(line), fp ) != NULL )
+        {
+        if( line[0] == '#' || line[0] == '\n' )
+            continue;
+
+        n = sscanf( line, "%ld , %d , %f", &t, &adc, &heading );
+        if( n < 2 || t < (long)trace->adc.size() )
+            continue;
+        if( n < 3 )
+            hasTruth = false;
+
+        // hold the previous sample up to this one
+        while( (long)trace->adc.size() < t )
+            {
+            trace->adc.push_back( trace->adc.empty() ? adc : trace->adc.back() );
+            trace->truth.push_back( trace->truth.empty() ? 0 : trace->truth.back() );
+            }
+
+        trace->adc.push_back( adc );
+        trace->truth.push_back( n == 3 ? heading : 0 );
+        }
+
+    fclose( fp );
+
+    if( !hasTruth )
+        trace->truth.clear();
+
+    return( !trace->adc.empty() );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Create a trace from the true rate and the change in bias        */
+/*-----------------------------------------------------------------------------*/
+
+static bool
+GyroTraceBuild( gyroTrace *trace, const char *name, const std::vector<double> &rate,
+                tGyroBias bias, unsigned int seed, int perMs )
+{
+    double  heading = 0;
+    double  adc;
+    long    t;
+
+    snprintf( trace->name, sizeof(trace->name), "%s", name );
+    trace->perMs = perMs;
+    trace->adc.resize( rate.size() );
+    trace->truth.resize( rate.size() / perMs );
+
+    for(t=0;t<(long)rate.size();t++)
+        {
+        adc = kGyroTraceBias + rate[t] * kGyroTraceCountsPerDps + kNoiseCounts * GyroTraceNoise( &seed );
+        if( bias != NULL )
+            adc += bias( t / perMs );
+
+        trace->adc[t] = (short)lround( adc );
+        if( t % perMs == 0 && t / perMs < (long)trace->truth.size() )
+            trace->truth[ t / perMs ] = (float)heading;
+
+        heading += rate[t] / (1000.0 * perMs);
+        }
+
+    return( !trace->truth.empty() );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Create a synthetic trace from one of the motion profiles        */
+/** @param[in] trace the trace to fill                                         */
+/** @param[in] name the profile name                                          */
+/** @param[in] durationMs trace length                                         */
+/** @param[in] seed noise seed                                                */
+/** @param[in] perMs ADC conversions per mS                                    */
+/** @returns   true on success, false if the profile is unknown               */
+/*-----------------------------------------------------------------------------*/
+
+bool
+GyroTraceSynthesize( gyroTrace *trace, const char *name, long durationMs, unsigned int seed, int perMs )
+{
+    gyroSynthetic      *s = NULL;
+    std::vector<double> rate( durationMs * perMs );
+    long                t;
+    int                 i;
+
+    for(i=0;i<kNumbSynthetics;i++)
+        if( strcmp( synthetics[i].name, name ) == 0 )
+            s = &synthetics[i];
+
+    if( s == NULL || perMs < 1 )
+        return( false );
+
+    for(t=0;t<durationMs * perMs;t++)
+        {
+        rate[t] = s->profile( t / perMs );
+        if( s->vibration != NULL )
+            rate[t] += s->vibration( t / (1000.0 * perMs) );
+        }
+
+    return( GyroTraceBuild( trace, name, rate, s->bias, seed, perMs ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Create a trace from the true rate                               */
+/** @param[in] trace the trace to fill                                         */
+/** @param[in] name the trace name                                            */
+/** @param[in] rate true rate in deg/sec, perMs per mS                         */
+/** @param[in] seed noise seed                                                */
+/** @param[in] perMs ADC conversions per mS, each has its own noise           */
+/** @returns   true on success                                                 */
+/*-----------------------------------------------------------------------------*/
+
+bool
+GyroTraceFromRate( gyroTrace *trace, const char *name, const std::vector<double> &rate, unsigned int seed, int perMs )
+{
+    return( GyroTraceBuild( trace, name, rate, NULL, seed, perMs ) );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     List the synthetic profiles                                     */
+/*-----------------------------------------------------------------------------*/
+
+void
+GyroTraceSyntheticList( FILE *fp )
+{
+    int     i;
+
+    for(i=0;i<kNumbSynthetics;i++)
+        fprintf( fp, "  %-12s %s\n", synthetics[i].name, synthetics[i].description );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Trace accessors                                                 */
+/*-----------------------------------------------------------------------------*/
+
+long
+GyroTraceLengthGet( const gyroTrace *trace )
+{
+    return( (long)trace->adc.size() / trace->perMs );
+}
+
+bool
+GyroTraceHasTruth( const gyroTrace *trace )
+{
+    return( !trace->truth.empty() );
+}
+
+float
+GyroTraceTruthGet( const gyroTrace *trace, long timeMs )
+{
+    if( trace->truth.empty() )
+        return( 0 );
+    if( timeMs >= (long)trace->truth.size() )
+        timeMs = (long)trace->truth.size() - 1;
+
+    return( trace->truth[ timeMs ] );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Sensor source for RobotcSourceSet, arg is the trace             */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The last sample is held if the simulation runs past the end of the trace
+ */
+
+int
+GyroTraceSource( long timeMs, void *arg )
+{
+    gyroTrace  *trace = (gyroTrace *)arg;
+
+    if( timeMs >= GyroTraceLengthGet( trace ) )
+        timeMs = GyroTraceLengthGet( trace ) - 1;
+
+    return( trace->adc[ timeMs * trace->perMs ] );
+}
@@ -0,0 +1,88 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroTrace.h                                                  */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+// Stop recursive includes
+#ifndef __GYROTRACE__
+#define __GYROTRACE__
+
+#include <vector>
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroTrace.h
+  * @brief   Recorded and synthetic raw gyro ADC traces for the host build
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   A trace is one raw ADC sample per mS with, when known, the true heading
+ *   at that time.  Trace files are plain text, one sample per line as
+ *
+ *       time_ms, adc [, heading_deg]
+ *
+ *   Lines starting with # are ignored, a sample is held until the next line
+ *   so logs recorded at a lower rate than 1mS can be used directly.
+ *
+ *   Synthetic traces can hold several ADC conversions per mS so the heading
+ *   follows vibration faster than 1kHz.  GyroTraceSource sees the first
+ *   conversion of each mS, as a task reading the port at the start of it.
+ */
+
+// Nominal sensor, the VEX gyro read by the cortex 12 bit ADC
+#define kGyroTraceBias          1860    ///< zero rate ADC value
+#define kGyroTraceCountsPerDps  1.3     ///< ADC counts per deg/sec
+
+// Synthetic traces are stationary for this long, longer than any calibration
+#define kGyroTraceSettleMs      2500
+
+// Structure to hold one trace
+typedef struct _gyroTrace {
+    char                name[64];
+    std::vector<short>  adc;            ///< raw ADC, perMs per mS
+    std::vector<float>  truth;          ///< true heading in deg, one per mS, may be empty
+    int                 perMs;          ///< ADC conversions per mS
+    } gyroTrace;
+
+bool    GyroTraceLoad( gyroTrace *trace, const char *filename );
+bool    GyroTraceSynthesize( gyroTrace *trace, const char *name, long durationMs, unsigned int seed = 1, int perMs = 1 );
+bool    GyroTraceFromRate( gyroTrace *trace, const char *name, const std::vector<double> &rate, unsigned int seed = 1, int perMs = 1 );
+void    GyroTraceSyntheticList( FILE *fp );
+long    GyroTraceLengthGet( const gyroTrace *trace );
+bool    GyroTraceHasTruth( const gyroTrace *trace );
+float   GyroTraceTruthGet( const gyroTrace *trace, long timeMs );
+int     GyroTraceSource( long timeMs, void *arg );
+
+#endif  // __GYROTRACE__
@@ -0,0 +1,350 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     gyroTurn.cpp                                                 */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#include <vector>
+
+#include "robotc.h"
+#include "gyroTrace.h"
+
+#include "../gyroLib/gyroLib2.c"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    gyroTurn.cpp
+  * @brief   Compare the profiled turn controller with a plain P loop
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   A drivetrain model turns the robot from the motor powers and drives the
+ *   gyro port with the rate it turns at, so GyroTask, gyroSim and the
+ *   controller all run as they would on the robot.  The same run of turns
+ *   is made by the library controller, with both profile shapes, and by
+ *   the P loop teams write, polling GyroAngleAbsGet every 20mS, at a range
+ *   of gains.
+ *
+ *   A turn has settled once the gyro heading stays within kSettleDeg of
+ *   the target, the controllers can do nothing about gyro error.  The true
+ *   heading error at the end of the run is shown as well.  Fails unless the
+ *   s curve controller settles sooner on average than the best P gain, or
+ *   if a full or hot reinit part way through a turn leaves the motors
+ *   running.
+ */
+
+#define kPlantRate          360.0       ///< deg/sec at full power
+#define kPlantTau           0.10        ///< sec, time constant of the drivetrain
+#define kPlantDeadband      12          ///< power needed to move at all
+#define kPlantStiction      10.0        ///< it will not turn slower than this, deg/sec
+
+#define kLeft               port1
+#define kRight              port10
+
+#define kUserPeriod         20          ///< P loop period in mS
+#define kWindow             2500        ///< mS allowed for each turn
+#define kSettleDeg          1.0
+
+// the run of turns, in degrees
+static  const float turns[] = { 90, 90, -90, -90, 90, -90, 180, -180, 45, -45 };
+
+#define kNumbTurns  (int)(sizeof(turns) / sizeof(turns[0]))
+
+// P loop gains tried
+static  const float pGains[] = { 1.0, 1.5, 2.0, 3.0, 4.0, 6.0, 8.0 };
+
+#define kNumbGains  (int)(sizeof(pGains) / sizeof(pGains[0]))
+
+// Drivetrain state
+static  double          plantRate;
+static  double          plantHeading;
+static  unsigned int    plantSeed;
+static  std::vector<double> plantLog;
+static  std::vector<double> gyroLog;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Drivetrain model, turns the robot every mS                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   First order response to the difference of the two sides, less a dead
+ *   band for friction.  Once slow it sticks unless driven hard enough to
+ *   break away, so it never creeps slower than the gyro can see.
+ */
+
+static void
+PlantTask()
+{
+    double  u, drive;
+
+    while( true )
+        {
+        u = (motor[ kRight ] - motor[ kLeft ]) / 2.0;
+
+        if( fabs( u ) > kPlantDeadband )
+            drive = (u > 0 ? 1 : -1) * (fabs( u ) - kPlantDeadband) / (127.0 - kPlantDeadband) * kPlantRate;
+        else
+            drive = 0;
+
+        plantRate += (drive - plantRate) * 0.001 / kPlantTau;
+        if( fabs( drive ) < kPlantStiction && fabs( plantRate ) < kPlantStiction )
+            plantRate = 0;
+
+        plantHeading += plantRate * 0.001;
+        plantLog.push_back( plantHeading );
+        gyroLog.push_back( GyroAngleAbsGet() );
+
+        wait1Msec( 1 );
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Gyro port source, the rate the model is turning at             */
+/*-----------------------------------------------------------------------------*/
+
+static int
+PlantSource( long timeMs, void *arg )
+{
+    double  u1, u2;
+
+    (void)timeMs;
+    (void)arg;
+
+    // same noise as the synthetic traces
+    plantSeed = plantSeed * 1103515245 + 12345;
+    u1 = ((plantSeed >> 8) + 1.0) / 16777217.0;
+    plantSeed = plantSeed * 1103515245 + 12345;
+    u2 = (plantSeed >> 8) / 16777216.0;
+
+    return( (int)lround( kGyroTraceBias + plantRate * kGyroTraceCountsPerDps +
+                         1.5 * sqrt( -2.0 * log( u1 ) ) * cos( 2.0 * PI * u2 ) ) );
+}
+
+// Structure to hold the results of one run of turns
+typedef struct _turnResult {
+    double  settleMean;                 ///< mS
+    long    settleMax;                  ///< mS
+    double  overshoot;                  ///< largest, deg
+    int     unsettled;                  ///< turns still moving at the end of the window
+    double  truth;                      ///< true heading error at the end, deg
+    } turnResult;
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Make the run of turns                                           */
+/** @param[in] pGain P loop gain, or 0 for the library controller             */
+/** @param[in] shape library profile shape                                    */
+/*-----------------------------------------------------------------------------*/
+
+static void
+TurnRun( float pGain, int shape, turnResult *r )
+{
+    gyroTurnParams  params;
+    float           target = 0;
+    long            start, t, settled;
+    double          err, over;
+    float           power;
+    int             i;
+
+    RobotcReset();
+    plantRate    = 0;
+    plantHeading = 0;
+    plantSeed    = 1;
+    plantLog.clear();
+    gyroLog.clear();
+
+    RobotcSourceSet( in1, PlantSource, NULL );
+    startTask( PlantTask );
+
+    GyroInit( in1 );
+    GyroTurnInit( kLeft, kRight );
+    GyroTurnParamsGet( &params );
+    params.shape = shape;
+    GyroTurnParamsSet( &params );
+
+    // calibrate
+    RobotcRun( kGyroTraceSettleMs );
+
+    r->settleMean = 0;
+    r->settleMax  = 0;
+    r->overshoot  = 0;
+    r->unsettled  = 0;
+
+    for(i=0;i<kNumbTurns;i++)
+        {
+        target += turns[i];
+        start   = nSysTime;
+
+        if( pGain == 0 )
+            {
+            GyroTurnTo( target );
+            RobotcRun( kWindow );
+            }
+        else
+            {
+            for(t=0;t<kWindow;t+=kUserPeriod)
+                {
+                power = pGain * (target - GyroAngleAbsGet());
+                if( power > 127 )
+                    power = 127;
+                if( power < -127 )
+                    power = -127;
+                motor[ kLeft ]  = -power;
+                motor[ kRight ] =  power;
+                RobotcRun( kUserPeriod );
+                }
+            }
+
+        // settled after the last time outside the band
+        settled = 0;
+        for(t=start;t<start+kWindow;t++)
+            {
+            err  = gyroLog[t] - target;
+            over = (turns[i] > 0) ? err : -err;
+            if( over > r->overshoot )
+                r->overshoot = over;
+            if( fabs( err ) > kSettleDeg )
+                settled = t + 1 - start;
+            }
+        if( settled >= kWindow )
+            r->unsettled++;
+
+        r->settleMean += settled;
+        if( settled > r->settleMax )
+            r->settleMax = settled;
+        }
+
+    r->settleMean /= kNumbTurns;
+    r->truth       = plantHeading - target;
+
+    GyroTurnStop();
+    stopTask( PlantTask );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Reinit the gyro half way through a turn                         */
+/** @param[in] hot a hot reinit rather than a full one                        */
+/** @returns   true if the motors stop and stay stopped until it is done       */
+/*-----------------------------------------------------------------------------*/
+
+static bool
+TurnReinit( bool hot )
+{
+    long    t;
+    bool    ok = true;
+
+    RobotcReset();
+    plantRate    = 0;
+    plantHeading = 0;
+    plantSeed    = 1;
+    plantLog.clear();
+    gyroLog.clear();
+
+    RobotcSourceSet( in1, PlantSource, NULL );
+    startTask( PlantTask );
+
+    GyroInit( in1 );
+    GyroTurnInit( kLeft, kRight );
+    RobotcRun( kGyroTraceSettleMs );
+
+    GyroTurnTo( 90 );
+    RobotcRun( 200 );
+    if( motor[ kLeft ] == 0 && motor[ kRight ] == 0 )
+        ok = false;
+
+    // the task acts on it by its next pass
+    GyroReinit( hot );
+    RobotcRun( GYRO_PERIOD_DEFAULT );
+    t = 0;
+    do  {
+        if( motor[ kLeft ] != 0 || motor[ kRight ] != 0 )
+            ok = false;
+        RobotcRun( 1 );
+        } while( ++t < kGyroTraceSettleMs && !(GyroValidGet() && GyroRecalDoneGet()) );
+
+    printf( "%s reinit mid turn, motors %s until the gyro is ready again\n",
+            hot ? "hot " : "full", ok ? "stopped" : "NOT stopped" );
+
+    stopTask( PlantTask );
+    return( ok );
+}
+
+static void
+TurnPrint( const char *name, turnResult *r )
+{
+    printf( "%-14s %8.0f mS %8ld mS %8.2f deg %6d %8.2f deg\n", name,
+            r->settleMean, r->settleMax, r->overshoot, r->unsettled, r->truth );
+}
+
+int
+main( int argc, char **argv )
+{
+    turnResult  r, best, scurve;
+    float       bestGain = 0;
+    char        name[32];
+    bool        ok;
+    int         i;
+
+    (void)argc;
+    (void)argv;
+
+    printf( "%-14s %11s %11s %12s %6s %12s\n", "controller", "mean settle", "max settle", "overshoot", "late", "true error" );
+
+    best.settleMean = 1e9;
+    for(i=0;i<kNumbGains;i++)
+        {
+        TurnRun( pGains[i], 0, &r );
+        snprintf( name, sizeof(name), "P %.1f", pGains[i] );
+        TurnPrint( name, &r );
+
+        // a turn still out at the end of its window counts as the window
+        if( r.settleMean < best.settleMean )
+            {
+            best     = r;
+            bestGain = pGains[i];
+            }
+        }
+
+    TurnRun( 0, kGyroProfileTrapezoid, &r );
+    TurnPrint( "trapezoid", &r );
+    TurnRun( 0, kGyroProfileSCurve, &scurve );
+    TurnPrint( "s curve", &scurve );
+
+    printf( "s curve settles %.0f mS sooner than the best P gain, %.1f\n",
+            best.settleMean - scurve.settleMean, bestGain );
+
+    ok = scurve.unsettled == 0 && scurve.settleMean < best.settleMean;
+    ok = TurnReinit( false ) && ok;
+    ok = TurnReinit( true ) && ok;
+    printf( "%s\n", ok ? "PASS" : "FAIL" );
+    return( ok ? 0 : 1 );
+}
@@ -0,0 +1,613 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     robotc.cpp                                                   */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+// The task switch longjmps between stacks, which the fortified longjmp
+// rejects, so make sure it is not in use for this file
+#undef  _FORTIFY_SOURCE
+
+#include <setjmp.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "robotc.h"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    robotc.cpp
+  * @brief   Virtual clock, cooperative task scheduler and sensor ports
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Each ROBOTC task runs on its own stack.  A new task is entered once with
+ *   setcontext, after that all switches are _setjmp/_longjmp pairs which do
+ *   not touch the signal mask and so avoid a system call per switch.
+ *
+ *   The scheduler always resumes the task with the earliest wake time, ties
+ *   are broken in the order the tasks went to sleep.  When the earliest wake
+ *   time is in the future the virtual clock jumps straight to it.
+ */
+
+#define kMaxTasks           20
+#define kTaskStackSize      (64 * 1024)
+#define kLcdLines           2
+#define kLcdWidth           16
+
+// Structure to hold one emulated task
+typedef struct _robotcTask {
+    tRobotcTask     fn;             ///< task entry point, NULL if slot unused
+    bool            fresh;          ///< not yet entered, use ctx not jb
+    long            wake;           ///< virtual time the task may run again
+    unsigned long   order;          ///< tie break for equal wake times
+    ucontext_t      ctx;            ///< initial context
+    jmp_buf         jb;             ///< saved context when suspended
+    char           *stack;
+    long            runs;           ///< times the task was resumed
+    double          cpu;            ///< wall time spent in the task, seconds
+    long            blocks;         ///< basic blocks run, see RobotcTaskBlocksGet
+    } robotcTask;
+
+// Structure to hold one sensor port
+typedef struct _robotcPort {
+    TSensorTypes    type;
+    tRobotcSource   source;
+    void           *arg;
+    } robotcPort;
+
+long                    nSysTime = 0;
+int                     motor[ kNumbMotors ];
+bool                    bLCDBacklight = false;
+
+RobotcSensorValueArray  SensorValue;
+RobotcAnalogValueArray  RobotcAnalogValue;
+RobotcSensorTypeArray   SensorType;
+
+static  robotcTask      tasks[ kMaxTasks ];
+static  robotcTask     *current = NULL;
+static  jmp_buf         schedJb;
+static  unsigned long   sleepOrder = 0;
+static  bool            timing = false;
+
+static  int             jitterMax = 0;
+static  int             jitterPercent = 0;
+static  unsigned int    jitterSeed = 1;
+
+static  robotcPort      ports[ kNumbOfRealSensors ];
+
+static  char            lcd[ kLcdLines ][ kLcdWidth + 1 ];
+static  bool            lcdEcho = false;
+static  long            lcdWrites = 0;
+
+static  FILE           *uartFile[ kNumbUarts ];
+static  long            uartBytes[ kNumbUarts ];
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Entry point for every task, runs the task then releases it      */
+/*-----------------------------------------------------------------------------*/
+
+static void
+RobotcTaskEntry()
+{
+    current->fn();
+
+    // task exited normally
+    current->fn = NULL;
+    _longjmp( schedJb, 1 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Suspend the current task and return to the scheduler            */
+/*-----------------------------------------------------------------------------*/
+
+static void
+RobotcYield( long wake )
+{
+    // not called from a task, nothing to suspend
+    if( current == NULL )
+        return;
+
+    // simulate a busy cpu, sometimes the task is run late
+    if( jitterMax > 0 )
+        {
+        jitterSeed = jitterSeed * 1103515245 + 12345;
+        if( (int)((jitterSeed >> 16) % 100) < jitterPercent )
+            {
+            jitterSeed = jitterSeed * 1103515245 + 12345;
+            wake += 1 + (jitterSeed >> 16) % jitterMax;
+            }
+        }
+
+    current->wake  = wake;
+    current->order = sleepOrder++;
+
+    if( !_setjmp( current->jb ) )
+        _longjmp( schedJb, 1 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Start (or restart) a task                                       */
+/** @param[in] fn the task                                                     */
+/** @param[in] priority unused, all tasks are equal on the host               */
+/*-----------------------------------------------------------------------------*/
+
+void
+startTask( tRobotcTask fn, int priority )
+{
+    robotcTask *t = NULL;
+    int         i;
+
+    (void)priority;
+
+    // restart if already running, otherwise use the first free slot
+    for(i=0;i<kMaxTasks && t == NULL;i++)
+        if( tasks[i].fn == fn )
+            t = &tasks[i];
+    for(i=0;i<kMaxTasks && t == NULL;i++)
+        if( tasks[i].fn == NULL )
+            t = &tasks[i];
+
+    if( t == NULL )
+        {
+        fprintf( stderr, "robotc: too many tasks\n" );
+        abort();
+        }
+
+    // restarting ourself would pull the stack out from under us
+    if( t == current )
+        {
+        fprintf( stderr, "robotc: task cannot restart itself\n" );
+        abort();
+        }
+
+    if( t->stack == NULL )
+        t->stack = (char *)malloc( kTaskStackSize );
+
+    getcontext( &t->ctx );
+    t->ctx.uc_stack.ss_sp   = t->stack;
+    t->ctx.uc_stack.ss_size = kTaskStackSize;
+    t->ctx.uc_link          = NULL;
+    makecontext( &t->ctx, RobotcTaskEntry, 0 );
+
+    t->fn    = fn;
+    t->fresh = true;
+    t->wake  = nSysTime;
+    t->order = sleepOrder++;
+    t->runs   = 0;
+    t->cpu    = 0;
+    t->blocks = 0;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Stop a task, a task may stop itself                             */
+/** @param[in] fn the task                                                     */
+/*-----------------------------------------------------------------------------*/
+
+void
+stopTask( tRobotcTask fn )
+{
+    int     i;
+
+    for(i=0;i<kMaxTasks;i++)
+        {
+        if( tasks[i].fn == fn )
+            {
+            tasks[i].fn = NULL;
+
+            if( &tasks[i] == current )
+                _longjmp( schedJb, 1 );
+            }
+        }
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Delays, the only places virtual time can pass                   */
+/*-----------------------------------------------------------------------------*/
+
+void
+wait1Msec( int ms )
+{
+    RobotcYield( nSysTime + ms );
+}
+
+void
+wait10Msec( int ms )
+{
+    RobotcYield( nSysTime + ms * 10 );
+}
+
+void
+EndTimeSlice()
+{
+    RobotcYield( nSysTime );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Run all tasks until the virtual clock advances by durationMs    */
+/** @param[in] durationMs how long to run                                      */
+/*-----------------------------------------------------------------------------*/
+
+static double
+RobotcClock()
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( ts.tv_sec + ts.tv_nsec / 1e9 );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Host wall clock in uS, for GYRO_TIMING_CLOCK                    */
+/*-----------------------------------------------------------------------------*/
+
+long
+RobotcMicros()
+{
+    return( (long)(RobotcClock() * 1e6) );
+}
+
+void
+RobotcRun( long durationMs )
+{
+    long        end = nSysTime + durationMs;
+    robotcTask *next;
+    volatile double start = 0;
+    int         i;
+
+    while( true )
+        {
+        // find the task that wants to run first
+        next = NULL;
+        for(i=0;i<kMaxTasks;i++)
+            {
+            robotcTask *t = &tasks[i];
+
+            if( t->fn == NULL )
+                continue;
+            if( next == NULL || t->wake < next->wake ||
+               (t->wake == next->wake && t->order < next->order) )
+                next = t;
+            }
+
+        if( next == NULL || next->wake > end )
+            break;
+
+        if( next->wake > nSysTime )
+            nSysTime = next->wake;
+
+        current = next;
+        current->runs++;
+        if( timing )
+            start = RobotcClock();
+
+        if( !_setjmp( schedJb ) )
+            {
+            if( current->fresh )
+                {
+                current->fresh = false;
+                setcontext( &current->ctx );
+                }
+            else
+                _longjmp( current->jb, 1 );
+            }
+
+        if( timing )
+            current->cpu += RobotcClock() - start;
+        current = NULL;
+        }
+
+    nSysTime = end;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Enable per task cpu time accounting                             */
+/** @param[in] enable true to time every task switch                          */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Timing adds two clock reads to every switch so it is off by default,
+ *   the cost of the switch itself is included in each task's time.
+ */
+
+void
+RobotcTimingEnable( bool enable )
+{
+    timing = enable;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Make tasks wake late, simulating a heavily loaded cpu           */
+/** @param[in] maxMs the largest extra delay, 0 to disable                     */
+/** @param[in] percent how often a wait is extended                            */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   The delays are pseudo random but repeat after every RobotcReset
+ */
+
+void
+RobotcJitterSet( int maxMs, int percent )
+{
+    jitterMax     = maxMs;
+    jitterPercent = percent;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Get statistics for a running task                               */
+/** @param[in] fn the task                                                     */
+/** @param[out] runs number of times the task was resumed                     */
+/** @param[out] seconds time spent in the task                                 */
+/** @returns   false if the task is not running                                */
+/*-----------------------------------------------------------------------------*/
+
+bool
+RobotcTaskStatsGet( tRobotcTask fn, long *runs, double *seconds )
+{
+    int     i;
+
+    for(i=0;i<kMaxTasks;i++)
+        {
+        if( tasks[i].fn == fn )
+            {
+            *runs    = tasks[i].runs;
+            *seconds = tasks[i].cpu;
+            return( true );
+            }
+        }
+
+    return( false );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Get the basic blocks a running task has executed                */
+/** @param[in] fn the task                                                     */
+/** @param[out] blocks basic blocks run since the task started                 */
+/** @returns   false if the task is not running                                */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *   Only code compiled with -fsanitize-coverage=trace-pc is counted, the
+ *   compiler calls __sanitizer_cov_trace_pc at the start of every block.
+ *   Unlike the time the count is the same on every run and every machine
+ *   for the same build, so it can catch a slower loop without noise.
+ */
+
+bool
+RobotcTaskBlocksGet( tRobotcTask fn, long *blocks )
+{
+    int     i;
+
+    for(i=0;i<kMaxTasks;i++)
+        {
+        if( tasks[i].fn == fn )
+            {
+            *blocks = tasks[i].blocks;
+            return( true );
+            }
+        }
+
+    return( false );
+}
+
+extern "C" void
+__sanitizer_cov_trace_pc( void )
+{
+    if( current != NULL )
+        current->blocks++;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Stop all tasks, reset the clock and disconnect all sensors      */
+/*-----------------------------------------------------------------------------*/
+
+void
+RobotcReset()
+{
+    int     i;
+
+    for(i=0;i<kMaxTasks;i++)
+        tasks[i].fn = NULL;
+
+    for(i=0;i<kNumbOfRealSensors;i++)
+        {
+        ports[i].type   = sensorNone;
+        ports[i].source = NULL;
+        ports[i].arg    = NULL;
+        }
+
+    for(i=0;i<kLcdLines;i++)
+        {
+        memset( lcd[i], ' ', kLcdWidth );
+        lcd[i][kLcdWidth] = 0;
+        }
+
+    for(i=0;i<kNumbMotors;i++)
+        motor[i] = 0;
+
+    for(i=0;i<kNumbUarts;i++)
+        {
+        uartFile[i]  = NULL;
+        uartBytes[i] = 0;
+        }
+
+    nSysTime   = 0;
+    sleepOrder = 0;
+    jitterSeed = 1;
+    lcdWrites  = 0;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief     Connect a data source to a sensor port                          */
+/** @param[in] port the sensor port                                            */
+/** @param[in] source function returning the raw value at a given time         */
+/** @param[in] arg passed back to source                                       */
+/*-----------------------------------------------------------------------------*/
+
+void
+RobotcSourceSet( tSensors port, tRobotcSource source, void *arg )
+{
+    ports[port].source = source;
+    ports[port].arg    = arg;
+}
+
+/*-----------------------------------------------------------------------------*/
+/*  Sensor arrays                                                              */
+/*-----------------------------------------------------------------------------*/
+
+int
+RobotcAnalogValueArray::operator[]( int port ) const
+{
+    if( port < 0 || port >= kNumbOfRealSensors || ports[port].source == NULL )
+        return( 0 );
+
+    return( ports[port].source( nSysTime, ports[port].arg ) );
+}
+
+int
+RobotcSensorValueArray::operator[]( int port ) const
+{
+    if( port >= 0 && port < kNumbAnalogSensors && ports[port].type == sensorGyro )
+        return( RobotcGyroFirmwareValue( (tSensors)port ) );
+
+    return( RobotcAnalogValue[ port ] );
+}
+
+RobotcSensorTypeRef::operator TSensorTypes() const
+{
+    return( ports[port].type );
+}
+
+RobotcSensorTypeRef &
+RobotcSensorTypeRef::operator=( TSensorTypes type )
+{
+    // a change of type resets the firmware gyro, as on the cortex
+    if( port < kNumbAnalogSensors && ports[port].type == sensorGyro )
+        RobotcGyroFirmwareStop( (tSensors)port );
+
+    ports[port].type = type;
+
+    if( port < kNumbAnalogSensors && type == sensorGyro )
+        RobotcGyroFirmwareStart( (tSensors)port );
+
+    return( *this );
+}
+
+/*-----------------------------------------------------------------------------*/
+/*  LCD                                                                        */
+/*-----------------------------------------------------------------------------*/
+
+void
+displayLCDString( int line, int pos, const char *str )
+{
+    int     i;
+
+    if( line < 0 || line >= kLcdLines )
+        return;
+
+    // first use before any reset
+    if( lcd[line][0] == 0 )
+        memset( lcd[line], ' ', kLcdWidth );
+
+    for(i=pos;i<kLcdWidth && *str;i++)
+        lcd[line][i] = *str++;
+    lcdWrites++;
+
+    if( lcdEcho )
+        printf( "%8ld lcd%d [%s]\n", nSysTime, line, lcd[line] );
+}
+
+void
+clearLCDLine( int line )
+{
+    if( line >= 0 && line < kLcdLines )
+        memset( lcd[line], ' ', kLcdWidth );
+}
+
+const char *
+RobotcLcdLineGet( int line )
+{
+    return( (line >= 0 && line < kLcdLines) ? lcd[line] : "" );
+}
+
+void
+RobotcLcdEcho( bool echo )
+{
+    lcdEcho = echo;
+}
+
+long
+RobotcLcdWritesGet()
+{
+    return( lcdWrites );
+}
+
+/*-----------------------------------------------------------------------------*/
+/*  Serial ports                                                               */
+/*-----------------------------------------------------------------------------*/
+
+void
+configureSerialPort( TUARTs port, int mode )
+{
+    (void)port;
+    (void)mode;
+}
+
+void
+setBaudRate( TUARTs port, int baud )
+{
+    (void)port;
+    (void)baud;
+}
+
+void
+sendChar( TUARTs port, char c )
+{
+    if( port < 0 || port >= kNumbUarts )
+        return;
+
+    if( uartFile[port] != NULL )
+        fputc( (unsigned char)c, uartFile[port] );
+    uartBytes[port]++;
+}
+
+void
+RobotcUartFileSet( TUARTs port, FILE *fp )
+{
+    if( port >= 0 && port < kNumbUarts )
+        uartFile[port] = fp;
+}
+
+long
+RobotcUartBytesGet( TUARTs port )
+{
+    return( (port >= 0 && port < kNumbUarts) ? uartBytes[port] : 0 );
+}
@@ -0,0 +1,221 @@
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*                        Copyright (c) James Pearman                          */
+/*                                   2026                                      */
+/*                            All Rights Reserved                              */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    Module:     robotc.h                                                     */
+/*    Author:     James Pearman                                                */
+/*    Created:    16 Oct 2026                                                  */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+/*                                                                             */
+/*    The author is supplying this software for use with the VEX IQ            */
+/*    control system. This file can be freely distributed and teams are        */
+/*    authorized to freely use this program , however, it is requested that    */
+/*    improvements or additions be shared with the Vex community via the vex   */
+/*    forum.  Please acknowledge the work of the authors when appropriate.     */
+/*    Thanks.                                                                  */
+/*                                                                             */
+/*    Licensed under the Apache License, Version 2.0 (the "License");          */
+/*    you may not use this file except in compliance with the License.         */
+/*    You may obtain a copy of the License at                                  */
+/*                                                                             */
+/*      http://www.apache.org/licenses/LICENSE-2.0                             */
+/*                                                                             */
+/*    Unless required by applicable law or agreed to in writing, software      */
+/*    distributed under the License is distributed on an "AS IS" BASIS,        */
+/*    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. */
+/*    See the License for the specific language governing permissions and      */
+/*    limitations under the License.                                           */
+/*                                                                             */
+/*    The author can be contacted on the vex forums as jpearman                */
+/*    or electronic mail using jbpearman_at_mac_dot_com                        */
+/*    Mentor for team 8888 RoboLancers, Pasadena CA.                           */
+/*                                                                             */
+/*-----------------------------------------------------------------------------*/
+
+// Stop recursive includes
+#ifndef __ROBOTC_HOST__
+#define __ROBOTC_HOST__
+
+/*-----------------------------------------------------------------------------*/
+/** @file    robotc.h
+  * @brief   Host (Linux) emulation of the ROBOTC primitives used by the libs
+*//*---------------------------------------------------------------------------*/
+/** @details
+ *   Just enough of the ROBOTC runtime to compile the library sources with a
+ *   host C++ compiler and run them against recorded or synthetic sensor data.
+ *   Tasks are cooperative coroutines and time is virtual, nSysTime only
+ *   advances when every task is blocked in wait1Msec, so a two minute match
+ *   runs in a fraction of a second.
+ *
+ *   Include this before any of the library .c files, exactly as ROBOTC would
+ *   have its own definitions in scope.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*-----------------------------------------------------------------------------*/
+/*  Language                                                                   */
+/*-----------------------------------------------------------------------------*/
+
+#define task                    void
+
+typedef char                    string[20];
+typedef void                    (*tRobotcTask)( void );
+
+#ifndef PI
+#define PI                      3.14159265358979323846
+#endif
+
+// Library functions in headers end up in more than one host file
+#define GYRO_TIMING_FUNC        inline
+#define GYRO_TELEMETRY_FUNC     inline
+
+/*-----------------------------------------------------------------------------*/
+/*  Sensors                                                                    */
+/*-----------------------------------------------------------------------------*/
+
+typedef enum {
+    in1 = 0, in2, in3, in4, in5, in6, in7, in8,
+    dgtl1, dgtl2, dgtl3, dgtl4, dgtl5, dgtl6,
+    dgtl7, dgtl8, dgtl9, dgtl10, dgtl11, dgtl12,
+
+    kNumbOfRealSensors
+    } tSensors;
+
+#define kNumbAnalogSensors      8
+
+typedef enum {
+    sensorNone = 0,
+    sensorAnalog,
+    sensorGyro,
+    sensorQuadEncoder
+    } TSensorTypes;
+
+/// source of raw sensor data, called with the virtual time in mS
+typedef int                     (*tRobotcSource)( long timeMs, void *arg );
+
+/// SensorValue[], what user code sees, the gyro is the integrated value
+class RobotcSensorValueArray {
+    public:
+        int operator[]( int port ) const;
+    };
+
+/// Raw port access, what the firmware sees, used by the gyro firmware model
+class RobotcAnalogValueArray {
+    public:
+        int operator[]( int port ) const;
+    };
+
+class RobotcSensorTypeRef {
+    public:
+        RobotcSensorTypeRef( int port ) : port( port ) {}
+        operator TSensorTypes() const;
+        RobotcSensorTypeRef & operator=( TSensorTypes type );
+    private:
+        int port;
+    };
+
+class RobotcSensorTypeArray {
+    public:
+        RobotcSensorTypeRef operator[]( int port ) { return RobotcSensorTypeRef( port ); }
+    };
+
+extern  RobotcSensorValueArray  SensorValue;
+extern  RobotcAnalogValueArray  RobotcAnalogValue;
+extern  RobotcSensorTypeArray   SensorType;
+
+/*-----------------------------------------------------------------------------*/
+/*  Motors                                                                     */
+/*-----------------------------------------------------------------------------*/
+
+typedef enum {
+    port1 = 0, port2, port3, port4, port5,
+    port6, port7, port8, port9, port10,
+
+    kNumbMotors
+    } tMotor;
+
+/// motor[] power, -127 to 127, nothing drives them unless a host model reads it
+extern  int     motor[ kNumbMotors ];
+
+/*-----------------------------------------------------------------------------*/
+/*  Tasks and time                                                             */
+/*-----------------------------------------------------------------------------*/
+
+#define kDefaultTaskPriority    7
+
+extern  long    nSysTime;
+
+void    startTask( tRobotcTask fn, int priority = kDefaultTaskPriority );
+void    stopTask( tRobotcTask fn );
+void    wait1Msec( int ms );
+void    wait10Msec( int ms );
+void    EndTimeSlice( void );
+
+/*-----------------------------------------------------------------------------*/
+/*  LCD                                                                        */
+/*-----------------------------------------------------------------------------*/
+
+extern  bool    bLCDBacklight;
+
+void    displayLCDString( int line, int pos, const char *str );
+void    clearLCDLine( int line );
+
+/*-----------------------------------------------------------------------------*/
+/*  Serial ports                                                               */
+/*-----------------------------------------------------------------------------*/
+
+typedef enum {
+    uartOne = 0, uartTwo,
+
+    kNumbUarts
+    } TUARTs;
+
+#define uartUserControl         0
+#define baudRate115200          115200
+
+void    configureSerialPort( TUARTs port, int mode );
+void    setBaudRate( TUARTs port, int baud );
+void    sendChar( TUARTs port, char c );
+
+/*-----------------------------------------------------------------------------*/
+/*  Host control, not part of ROBOTC                                           */
+/*-----------------------------------------------------------------------------*/
+
+void    RobotcReset( void );
+void    RobotcRun( long durationMs );
+void    RobotcTimingEnable( bool enable );
+void    RobotcJitterSet( int maxMs, int percent );
+bool    RobotcTaskStatsGet( tRobotcTask fn, long *runs, double *seconds );
+bool    RobotcTaskBlocksGet( tRobotcTask fn, long *blocks );
+void    RobotcSourceSet( tSensors port, tRobotcSource source, void *arg );
+const char *RobotcLcdLineGet( int line );
+void    RobotcLcdEcho( bool echo );
+long    RobotcLcdWritesGet( void );
+void    RobotcUartFileSet( TUARTs port, FILE *fp );
+long    RobotcUartBytesGet( TUARTs port );
+long    RobotcMicros( void );
+
+// Supplied by gyroFirmware.cpp, the model behind a port set to sensorGyro
+void    RobotcGyroFirmwareStart( tSensors port );
+void    RobotcGyroFirmwareStop( tSensors port );
+int     RobotcGyroFirmwareValue( tSensors port );
+// dead band and bias samples, used when the port is next set to sensorGyro
+void    RobotcGyroFirmwareParamsSet( tSensors port, int jitter, int calSamples );
+// gyroIntegratorSet, also used when the port is next set to sensorGyro
+void    RobotcGyroFirmwareIntegratorSet( tSensors port, int mode, bool soft );
+tRobotcTask RobotcGyroFirmwareTaskGet( tSensors port );
+#ifdef  GYRO_TIMING
+struct  _gyroTiming;
+bool    RobotcGyroFirmwareTimingGet( tSensors port, struct _gyroTiming *timing );
+#endif
+
+#endif  // __ROBOTC_HOST__